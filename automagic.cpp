@@ -17,19 +17,73 @@
 #include "gameV_0.h"
 #include "gameV_1.h"
 #include "gameV_2.h"
+#define AUTOMAGIC_ALLOCATION_HOOKS
+#include "aux_allocation.h"
+#include "aux_autotune.h"
 #include "aux_chrono.h"
 #include "aux_iterator.h"
+#include "aux_memory.h"
+#include "aux_parallel.h"
+#include "aux_perf.h"
+#include "aux_process.h"
+#include "aux_statistics.h"
+#include "aux_system.h"
+#include "aux_trace.h"
+#include "spell_stats.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <numeric>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <typeinfo>
+#include <vector>
+
+#ifndef AUTOMAGIC_CACHE_FILE
+#define AUTOMAGIC_CACHE_FILE "automagic_cache.txt"
+#endif
+
+// The compiler options the build used, e.g. -DAUTOMAGIC_BUILD_FLAGS="\"-O3 -march=native\"",
+// which ResultCache keys reports by
+#ifndef AUTOMAGIC_BUILD_FLAGS
+#define AUTOMAGIC_BUILD_FLAGS ""
+#endif
+
+#ifndef AUTOMAGIC_TUNING_FILE
+#define AUTOMAGIC_TUNING_FILE "automagic_tuning.txt"
+#endif
 
+//--------------------------------------------------------------------------------------------------
+//  The floating point lives aren't profiled by default, so instantiate the families whose Rend
+//  draws through BoundedUniformDistribution to keep them compiling.
+//--------------------------------------------------------------------------------------------------
+template struct Version2_1::Game<float>;
+template struct Version3_1::Game<double>;
+template struct Version2_2::Game<float>;
+template struct Version3_2::Game<double>;
+
+//--------------------------------------------------------------------------------------------------
+//  m_duration covers setting the game up and playing it; m_setup and m_play split it precisely.
 //--------------------------------------------------------------------------------------------------
 struct ProfileInfo {
     using Duration = std::chrono::milliseconds;
+    using SplitDuration = std::chrono::nanoseconds;
     using TurnCount = std::size_t;
 
     Duration m_duration{};
     TurnCount m_turnCount{};
+    SplitDuration m_setup{};
+    SplitDuration m_play{};
 
     ProfileInfo () = default;
     ProfileInfo (const Duration& duration, const TurnCount& turnCount) :
@@ -38,35 +92,410 @@ struct ProfileInfo {
     { }
 };
 
+//--------------------------------------------------------------------------------------------------
+//  ProfileSummary folds runs into constant space as they finish, so a version can play any number
+//  of games. Extremes, totals and mean/variance are exact; quantiles come from sketches accurate to
+//  QuantileSketch::c_relativeAccuracy. Summaries from separate threads or processes merge with no
+//  further loss, and are trivially copyable so they can be built in shared memory.
 //--------------------------------------------------------------------------------------------------
 struct ProfileSummary {
+    std::size_t m_count{};
     ProfileInfo m_maximum{
         ProfileInfo::Duration{std::numeric_limits<ProfileInfo::Duration::rep>::min()},
         std::numeric_limits<ProfileInfo::TurnCount>::min()
     };
-    ProfileInfo m_average{};
+    ProfileInfo m_total{};
     ProfileInfo m_minimum{
         ProfileInfo::Duration{std::numeric_limits<ProfileInfo::Duration::rep>::max()}, 
         std::numeric_limits<ProfileInfo::TurnCount>::max()
     };
+    RunningStatistics m_durations;      // Nanoseconds, as milliseconds would swamp short games
+    RunningStatistics m_setupTimes;     // Nanoseconds
+    RunningStatistics m_playTimes;      // Nanoseconds
+    QuantileSketch m_durationSketch;
+    QuantileSketch m_turnCountSketch;
+
+    void Add (const ProfileInfo& i) {
+        ++m_count;
+        m_maximum.m_duration = std::max(m_maximum.m_duration, i.m_duration);
+        m_maximum.m_turnCount = std::max(m_maximum.m_turnCount, i.m_turnCount);
+        m_total.m_duration += i.m_duration;
+        m_total.m_turnCount += i.m_turnCount;
+        m_minimum.m_duration = std::min(m_minimum.m_duration, i.m_duration);
+        m_minimum.m_turnCount = std::min(m_minimum.m_turnCount, i.m_turnCount);
+        m_durations.Add(static_cast<double>((i.m_setup + i.m_play).count()));
+        m_setupTimes.Add(static_cast<double>(i.m_setup.count()));
+        m_playTimes.Add(static_cast<double>(i.m_play.count()));
+        m_durationSketch.Add(static_cast<double>(i.m_duration.count()));
+        m_turnCountSketch.Add(static_cast<double>(i.m_turnCount));
+    }
+
+    void Merge (const ProfileSummary& other) {
+        m_count += other.m_count;
+        m_maximum.m_duration = std::max(m_maximum.m_duration, other.m_maximum.m_duration);
+        m_maximum.m_turnCount = std::max(m_maximum.m_turnCount, other.m_maximum.m_turnCount);
+        m_total.m_duration += other.m_total.m_duration;
+        m_total.m_turnCount += other.m_total.m_turnCount;
+        m_minimum.m_duration = std::min(m_minimum.m_duration, other.m_minimum.m_duration);
+        m_minimum.m_turnCount = std::min(m_minimum.m_turnCount, other.m_minimum.m_turnCount);
+        m_durations.Merge(other.m_durations);
+        m_setupTimes.Merge(other.m_setupTimes);
+        m_playTimes.Merge(other.m_playTimes);
+        m_durationSketch.Merge(other.m_durationSketch);
+        m_turnCountSketch.Merge(other.m_turnCountSketch);
+    }
+
+    ProfileInfo Average () const {
+        if (m_count == 0)
+            return {};
+        return {m_total.m_duration / m_count, m_total.m_turnCount / m_count};
+    }
+
+    // Clamped to the extremes, as a sketch bucket may reach past them (exact for a constant series)
+    ProfileInfo Quantile (double q) const {
+        if (m_count == 0)
+            return {};
+        const ProfileInfo::Duration duration{std::llround(m_durationSketch.Quantile(q))};
+        const auto turnCount = static_cast<ProfileInfo::TurnCount>(
+            std::llround(m_turnCountSketch.Quantile(q))
+        );
+        return {
+            std::min(std::max(duration, m_minimum.m_duration), m_maximum.m_duration),
+            std::min(std::max(turnCount, m_minimum.m_turnCount), m_maximum.m_turnCount),
+        };
+    }
 };
 
 //--------------------------------------------------------------------------------------------------
-template <typename G>
-void ProfileGame (const char* label) {
-
-    static const auto& profile = [] (auto& i) {
-        i.m_turnCount = timed_call(
-            i.m_duration,
-            [] () {
-                G game;
-                int turnCount = 0;
-                while (game.Turn())
-                    ++turnCount;
-                return turnCount;
+//  RunOrder is the order in which versions play. Sequential plays every run of one version before
+//  the next. The others play in rounds of one run per version, all from the same seed, starting
+//  the round with each version in turn (Rotate), in a shuffled order (Random) or alternately
+//  forwards and backwards (Abba).
+//--------------------------------------------------------------------------------------------------
+enum class RunOrder {
+    Sequential,
+    Rotate,
+    Random,
+    Abba,
+};
+
+//--------------------------------------------------------------------------------------------------
+//  ProfileOptions selects how many games each version plays. By default that is a fixed count;
+//  in adaptive mode games are played until the 95% confidence interval of the mean duration is
+//  within m_targetPrecision of the mean, or until the time or run budget is exhausted.
+//  A non-zero m_batchSize holds that many games at once in a page arena, split between
+//  m_threadCount workers. When m_cpus is set the runner is pinned to its first entry and batch
+//  workers to successive entries.
+//  m_processCount > 1 shards the runs between that many worker processes instead.
+//  Every run plays from m_seed, or from m_seed plus its run index with m_varySeeds.
+//  m_coldStart replaces the runs with m_runCount first turn latency samples (see ProfileColdStart).
+//  m_verifySeeds > 0 also checks each version against the others of its family (see GoldenOutputs).
+//  Any m_order but Sequential plays m_runCount rounds of every version (see ProfileInterleaved).
+//  m_reuseGames resets pooled games in place for each run instead of constructing new ones.
+//  m_gameThreads splits each turn of the large lobby versions between that many threads.
+//  m_useCache reuses the reports of versions which haven't changed (see ResultCache).
+//  m_live publishes progress while profiling for --watch in another process (see LiveMetrics).
+//  m_tune also profiles the fastest variant of Version3_3 on this machine (see TunedVersion), and
+//  m_retune measures its variants again rather than reuse the saved choice.
+//--------------------------------------------------------------------------------------------------
+struct ProfileOptions {
+    std::size_t m_runCount{100};
+    bool m_adaptive{};
+    double m_targetPrecision{0.01};
+    std::size_t m_minimumRuns{10};
+    std::size_t m_maximumRuns{100000};
+    std::chrono::milliseconds m_timeBudget{std::chrono::seconds{60}};
+    std::size_t m_batchSize{};
+    std::size_t m_threadCount{1};
+    PageMode m_pageMode{PageMode::Transparent};
+    bool m_perfCounters{};
+    bool m_pin{};
+    bool m_raisePriority{};
+    bool m_lockMemory{};
+    bool m_showEnvironment{};
+    std::vector<std::size_t> m_cpus;
+    std::size_t m_processCount{1};
+    std::uint32_t m_seed{std::mt19937::default_seed};
+    bool m_varySeeds{};
+    bool m_coldStart{};
+    std::size_t m_verifySeeds{};
+    RunOrder m_order{RunOrder::Sequential};
+    bool m_reuseGames{};
+    std::size_t m_gameThreads{1};
+    bool m_useCache{};
+    bool m_live{};
+    std::uint64_t m_watchProcess{};
+    bool m_tune{};
+    bool m_retune{};
+
+    std::uint32_t SeedFor (std::size_t run) const {
+        return m_varySeeds ? static_cast<std::uint32_t>(m_seed + run) : m_seed;
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+//  ParseOptions reads "--name" and "--name=value" arguments, returning false on anything it does
+//  not recognise so the caller can print the usage.
+//--------------------------------------------------------------------------------------------------
+bool ParseOptions (int argc, char** argv, ProfileOptions& options) {
+    static const auto& toSize = [] (const char* v) { return std::strtoull(v, nullptr, 10); };
+
+    static const struct {
+        const char* m_name;
+        void (*m_parse)(ProfileOptions&, const char*);
+        const char* m_value;
+        const char* m_help;
+    } c_options[] = {
+        {
+            "runs",
+            [] (auto& o, auto v) { o.m_runCount = toSize(v); },
+            "=N", "Games per version when not adaptive (default 100)",
+        },
+        {
+            "adaptive",
+            [] (auto& o, auto) { o.m_adaptive = true; },
+            "", "Play games until the mean duration reaches --precision",
+        },
+        {
+            "precision",
+            [] (auto& o, auto v) { o.m_targetPrecision = std::strtod(v, nullptr); },
+            "=F", "Relative 95% confidence interval target (default 0.01)",
+        },
+        {
+            "min-runs",
+            [] (auto& o, auto v) { o.m_minimumRuns = toSize(v); },
+            "=N", "Adaptive lower bound on games per version (default 10)",
+        },
+        {
+            "max-runs",
+            [] (auto& o, auto v) { o.m_maximumRuns = toSize(v); },
+            "=N", "Adaptive upper bound on games per version (default 100000)",
+        },
+        {
+            "budget-ms",
+            [] (auto& o, auto v) { o.m_timeBudget = std::chrono::milliseconds{toSize(v)}; },
+            "=N", "Adaptive time budget per version (default 60000)",
+        },
+        {
+            "batch",
+            [] (auto& o, auto v) { o.m_batchSize = toSize(v); },
+            "=N", "Hold N games at once in a page arena (default 0, one at a time)",
+        },
+        {
+            "threads",
+            [] (auto& o, auto v) { o.m_threadCount = std::max<std::size_t>(toSize(v), 1); },
+            "=N", "Worker threads sharing each batch (default 1)",
+        },
+        {
+            "huge-pages",
+            [] (auto& o, auto v) {
+                o.m_pageMode = std::strcmp(v, "explicit") == 0 ? PageMode::Explicit :
+                    std::strcmp(v, "none") == 0 ? PageMode::Default : PageMode::Transparent;
+            },
+            "=MODE", "Batch pages: none, thp or explicit (default thp)",
+        },
+        {
+            "perf",
+            [] (auto& o, auto) { o.m_perfCounters = true; },
+            "", "Report TLB, NUMA node and page fault counters",
+        },
+        {
+            "pin",
+            [] (auto& o, auto) { o.m_pin = true; },
+            "", "Pin the runner and each worker to its own core",
+        },
+        {
+            "priority",
+            [] (auto& o, auto) { o.m_raisePriority = true; },
+            "", "Raise the scheduling priority of the process",
+        },
+        {
+            "mlock",
+            [] (auto& o, auto) { o.m_lockMemory = true; },
+            "", "Lock all memory so no page is swapped during a run",
+        },
+        {
+            "env",
+            [] (auto& o, auto) { o.m_showEnvironment = true; },
+            "", "Print the CPU, frequency and kernel environment first",
+        },
+        {
+            "low-noise",
+            [] (auto& o, auto) {
+                o.m_pin = o.m_raisePriority = o.m_lockMemory = o.m_showEnvironment = true;
+            },
+            "", "All of --pin, --priority, --mlock and --env",
+        },
+        {
+            "processes",
+            [] (auto& o, auto v) { o.m_processCount = std::max<std::size_t>(toSize(v), 1); },
+            "=N", "Shard the runs of each version across N worker processes",
+        },
+        {
+            "game-threads",
+            [] (auto& o, auto v) { o.m_gameThreads = std::max<std::size_t>(toSize(v), 1); },
+            "=N", "Split the players of each large lobby turn (V4.2) between N threads",
+        },
+        {
+            "seed",
+            [] (auto& o, auto v) { o.m_seed = static_cast<std::uint32_t>(toSize(v)); },
+            "=S", "Engine seed for every run (default 5489, the engine default)",
+        },
+        {
+            "vary-seeds",
+            [] (auto& o, auto) { o.m_varySeeds = true; },
+            "", "Seed run i with S + i instead of S",
+        },
+        {
+            "cold-start",
+            [] (auto& o, auto) { o.m_coldStart = true; },
+            "", "Compare first turn latency in a fresh process against later turns",
+        },
+        {
+            "verify",
+            [] (auto& o, auto v) { o.m_verifySeeds = toSize(v); },
+            "=N", "Check each version plays N seeds exactly like the first of its family",
+        },
+        {
+            "order",
+            [] (auto& o, auto v) {
+                o.m_order = std::strcmp(v, "rotate") == 0 ? RunOrder::Rotate :
+                    std::strcmp(v, "random") == 0 ? RunOrder::Random :
+                    std::strcmp(v, "abba") == 0 ? RunOrder::Abba : RunOrder::Sequential;
+            },
+            "=ORDER", "sequential, rotate, random or abba; all but sequential pair the versions",
+        },
+        {
+            "reuse",
+            [] (auto& o, auto) { o.m_reuseGames = true; },
+            "", "Reset pooled games in place rather than construct one per run",
+        },
+        {
+            "cache",
+            [] (auto& o, auto) { o.m_useCache = true; },
+            "", "Reuse saved reports of unchanged versions (sequential order only)",
+        },
+        {
+            "tune",
+            [] (auto& o, auto) { o.m_tune = true; },
+            "", "Also profile the fastest V3.3 variant and batch width for this machine",
+        },
+        {
+            "retune",
+            [] (auto& o, auto) { o.m_tune = o.m_retune = true; },
+            "", "--tune, measuring the variants again rather than reuse the saved choice",
+        },
+        {
+            "live",
+            [] (auto& o, auto) { o.m_live = true; },
+            "", "Publish progress for --watch while profiling",
+        },
+        {
+            "watch",
+            [] (auto& o, auto v) { o.m_watchProcess = toSize(v); },
+            "=PID", "Only show the progress of the profiler running as process PID",
+        },
+    };
+
+    for (auto i = 1; i < argc; ++i) {
+        const auto* arg = argv[i];
+        const auto* option = std::find_if(
+            std::begin(c_options),
+            std::end(c_options),
+            [arg] (const auto& o) {
+                const auto length = std::strlen(o.m_name);
+                return std::strncmp(arg, "--", 2) == 0 &&
+                    std::strncmp(arg + 2, o.m_name, length) == 0 &&
+                    (arg[2 + length] == '\0' || arg[2 + length] == '=');
             }
         );
-    };
+        if (option == std::end(c_options)) {
+            std::cerr << "Usage: " << argv[0] << " [options]" << std::endl;
+            for (const auto& o : c_options) {
+                std::cerr << "  --" << std::left << std::setw(16);
+                std::cerr << std::string(o.m_name) + o.m_value << o.m_help << std::endl;
+            }
+            return false;
+        }
+        const auto* value = std::strchr(arg, '=');
+        option->m_parse(options, value ? value + 1 : "");
+    }
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+#if AUTOMAGIC_SPELL_STATS
+void OutputSpellStats (const SpellCounterArray& stats) {
+    const auto totalCycles = std::accumulate(
+        std::cbegin(stats),
+        std::cend(stats),
+        std::uint64_t{},
+        [] (auto total, const auto& s) { return total + s.m_cycles; }
+    );
+    for (std::size_t i = 0; i < stats.size(); ++i) {
+        const auto& s = stats[i];
+        if (s.m_calls == 0)
+            continue;
+        std::cout << c_spellNames[i];
+        std::cout << " Calls: " << s.m_calls;
+        std::cout << " Cycles: " << s.m_cycles;
+        std::cout << " (" << 100.0 * s.m_cycles / std::max(totalCycles, std::uint64_t{1}) << "%)";
+        std::cout << " Cycles/Call: " << s.m_cycles / s.m_calls;
+        std::cout << " Life/Call: " << s.m_lifeDelta / s.m_calls;
+        std::cout << std::endl;
+    }
+}
+#endif
+
+//--------------------------------------------------------------------------------------------------
+//  PrepareSystem applies the low noise settings to the process and the calling (runner) thread,
+//  warning about any the system refuses. It also calibrates TscClock so that no run pays for it.
+//--------------------------------------------------------------------------------------------------
+void PrepareSystem (ProfileOptions& options) {
+    if (options.m_pin) {
+        options.m_cpus = benchmark_cpus();
+        if (options.m_cpus.empty() || !pin_current_thread(options.m_cpus.front())) {
+            std::cerr << "Warning: could not pin the runner thread" << std::endl;
+            options.m_cpus.clear();
+        }
+    }
+    if (options.m_raisePriority && !raise_process_priority())
+        std::cerr << "Warning: could not raise the process priority" << std::endl;
+    if (options.m_lockMemory && !lock_process_memory())
+        std::cerr << "Warning: could not lock the process memory" << std::endl;
+    const auto& clock = TscClock::Get();
+
+    if (!options.m_showEnvironment)
+        return;
+    const auto cpu = options.m_cpus.empty() ? std::size_t{} : options.m_cpus.front();
+    const auto env = capture_environment(cpu);
+    std::cout << "CPU: " << env.m_cpuModel << std::endl;
+    std::cout << "CPUs: " << env.m_cpuCount;
+    std::cout << " Governor: " << env.m_governor;
+    std::cout << " Turbo: " << env.m_turbo;
+    std::cout << " SMT: " << env.m_smt;
+    std::cout << " Siblings: " << env.m_siblings;
+    std::cout << std::endl;
+    std::cout << "Kernel: " << env.m_kernel;
+    std::cout << " Pinned: ";
+    if (options.m_cpus.empty())
+        std::cout << "no";
+    else
+        std::cout << cpu;
+    std::cout << std::endl;
+    std::cout << "Clock: ";
+    if (clock.m_invariant)
+        std::cout << "TSC " << clock.Frequency() / 1e9 << "GHz";
+    else
+        std::cout << "steady_clock";
+    std::cout << " Overhead: " << clock.m_overhead.count() << "ns";
+    std::cout << std::endl << std::endl;
+    if (!env.IsQuiet())
+        std::cerr << "Warning: CPU frequency is not fixed; expect more variance" << std::endl;
+}
+
+//--------------------------------------------------------------------------------------------------
+void OutputSummary (const ProfileSummary& summary) {
     static const auto& output = [] (const auto& i, const char* label) {
         std::cout << label;
         std::cout << " Turns: " << i.m_turnCount;
@@ -74,64 +503,1464 @@ void ProfileGame (const char* label) {
         std::cout << std::endl;
     };
 
-    std::array<ProfileInfo, 100> info;
-    std::for_each(std::begin(info), std::end(info), profile);
-
-    ProfileSummary summary{};
-    (void)std::accumulate(
-        std::cbegin(info), 
-        std::cend(info),
-        std::ref(summary),
-        [] (auto& s, const auto& i) {
-            auto& summary = s.get();
-            summary.m_maximum.m_duration = std::max(summary.m_maximum.m_duration, i.m_duration);
-            summary.m_maximum.m_turnCount = std::max(summary.m_maximum.m_turnCount, i.m_turnCount);
-            summary.m_average.m_duration += i.m_duration;
-            summary.m_average.m_turnCount += i.m_turnCount;
-            summary.m_minimum.m_duration = std::min(summary.m_minimum.m_duration, i.m_duration);
-            summary.m_minimum.m_turnCount = std::min(summary.m_minimum.m_turnCount, i.m_turnCount);
-            return s;
+    output(summary.m_total, "Tot");
+    output(summary.m_maximum, "Max");
+    output(summary.Average(), "Avg");
+    output(summary.m_minimum, "Min");
+    output(summary.Quantile(0.50), "P50");
+    output(summary.Quantile(0.90), "P90");
+    output(summary.Quantile(0.99), "P99");
+    std::cout << "Setup Avg: " << summary.m_setupTimes.Mean() << "ns";
+    std::cout << " Play Avg: " << summary.m_playTimes.Mean() / 1e6 << "ms" << std::endl;
+}
+
+//--------------------------------------------------------------------------------------------------
+void OutputPerfCounters (const PerfCounters& counters, const PerfCounters::Values& values) {
+    std::cout << "Perf";
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        const auto e = static_cast<PerfCounters::Event>(i);
+        std::cout << " " << PerfCounters::Name(e) << ": ";
+        if (counters.Available(e))
+            std::cout << values[i];
+        else
+            std::cout << "n/a";
+    }
+    std::cout << std::endl;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  SeedGame resets a newly constructed game to 'seed'. Engines start from their default seed, so
+//  that common case skips the reset and the 624 word state isn't initialised twice. Resetting
+//  rather than just reseeding the engine lets games re-derive anything drawn from it at setup.
+//--------------------------------------------------------------------------------------------------
+template <typename G>
+void SeedGame (G& game, std::uint32_t seed) {
+    if (seed != std::decay_t<decltype(game.m_engine)>::default_seed)
+        game.Reset(seed);
+}
+
+//--------------------------------------------------------------------------------------------------
+//  GamePool keeps games which have already been constructed, so that a run can Reset one in place
+//  rather than construct (and first touch) a new one. Acquire hands out a game reset to 'seed',
+//  constructing another only if every pooled game is in use; the Lease puts it back.
+//  Seeding an engine is the bulk of a reset, so the pool also keeps an engine freshly seeded with
+//  the last seed used and copies it into games which are reset to the same seed.
+//--------------------------------------------------------------------------------------------------
+template <typename G>
+struct GamePool {
+    using Engine = std::decay_t<decltype(std::declval<G&>().m_engine)>;
+
+    std::mutex m_mutex;
+    std::vector<std::unique_ptr<G>> m_games;
+    Engine m_engine{};
+    std::uint32_t m_engineSeed{Engine::default_seed};
+
+    struct Lease {
+        GamePool& m_pool;
+        std::unique_ptr<G> m_game;
+
+        Lease (GamePool& pool, std::unique_ptr<G> game) : m_pool(pool), m_game(std::move(game)) { }
+        Lease (Lease&&) = default;
+        ~Lease () {
+            if (m_game)
+                m_pool.Release(std::move(m_game));
+        }
+    };
+
+    static GamePool& Get () {
+        static GamePool s_pool;
+        return s_pool;
+    }
+
+    void Warm (std::size_t count) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        while (m_games.size() < count)
+            m_games.push_back(std::make_unique<G>());
+    }
+
+    Lease Acquire (std::uint32_t seed) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        std::unique_ptr<G> game;
+        if (!m_games.empty()) {
+            game = std::move(m_games.back());
+            m_games.pop_back();
+        }
+        else {
+            game = std::make_unique<G>();
+        }
+        if (seed == m_engineSeed) {
+            game->Reset(m_engine);
+        }
+        else {
+            lock.unlock();
+            game->Reset(seed);
+            lock.lock();
+            m_engine = game->m_engine;
+            m_engineSeed = seed;
         }
+        return Lease(*this, std::move(game));
+    }
+
+    void Release (std::unique_ptr<G> game) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_games.push_back(std::move(game));
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+//  PlayOnce sets up one game, by constructing it or by resetting one from its GamePool, and plays
+//  it, timing the two separately.
+//--------------------------------------------------------------------------------------------------
+template <typename G>
+ProfileInfo::TurnCount PlayTurns (G& game) {
+    ProfileInfo::TurnCount turnCount = 0;
+    while (game.Turn())
+        ++turnCount;
+    return turnCount;
+}
+
+template <typename G>
+ProfileInfo PlayOnce (std::uint32_t seed, bool reuse) {
+    AUTOMAGIC_TRACE_SCOPE("Run");
+    TscClock::duration setup;
+    TscClock::duration play;
+    ProfileInfo info;
+    if (reuse) {
+        auto&& lease = timed_call<TscClock>(setup, [seed] {
+            AUTOMAGIC_TRACE_SCOPE("Reset");
+            return GamePool<G>::Get().Acquire(seed);
+        });
+        info.m_turnCount = timed_call<TscClock>(play, &PlayTurns<G>, *lease.m_game);
+    }
+    else {
+        auto&& game = timed_call<TscClock>(setup, [seed] {
+            AUTOMAGIC_TRACE_SCOPE("Construct");
+            G game{};
+            SeedGame(game, seed);
+            return game;
+        });
+        info.m_turnCount = timed_call<TscClock>(play, &PlayTurns<G>, game);
+    }
+    info.m_setup = setup;
+    info.m_play = play;
+    info.m_duration = std::chrono::duration_cast<ProfileInfo::Duration>(setup + play);
+    return info;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  LiveMetrics is the layout of the shared segment which --live publishes and --watch reads from
+//  another process. The runner publishes the version in progress with its summary so far, at most
+//  every c_interval; each worker (the runner itself, a batch thread or a shard process) publishes
+//  its own progress after every game. Every field is written by one thread only, through a
+//  Seqlocked, so publishing never waits on a reader. Times are steady clock nanoseconds, which
+//  processes on the same machine share, so the reader can work out rates and spot stalled workers.
+//--------------------------------------------------------------------------------------------------
+struct LiveMetrics {
+    static const std::uint32_t c_magic = 0x414d4c4d;  // "AMLM"
+    static const std::size_t c_workerCount = 64;     // --live allows no more workers than this
+    static constexpr std::chrono::milliseconds c_interval{100};
+
+    struct Version {
+        char m_label[16];
+        std::uint64_t m_ordinal;    // 1 for the first version profiled
+        std::uint64_t m_games;
+        std::uint64_t m_turns;
+        double m_mean;              // Milliseconds per game
+        double m_p99;
+        std::uint64_t m_started;
+        std::uint64_t m_updated;
+    };
+
+    struct Worker {
+        std::uint64_t m_ordinal;    // Of the version the counts are for
+        std::uint64_t m_games;
+        std::uint64_t m_turns;
+        std::uint64_t m_updated;
+    };
+
+    std::uint32_t m_magic{c_magic};
+    std::uint32_t m_size{sizeof(LiveMetrics)};
+    std::atomic<std::uint32_t> m_finished{};
+    Seqlocked<Version> m_version;
+    Seqlocked<Worker> m_workers[c_workerCount];
+
+    static std::string NameOf (std::uint64_t process) {
+        return "/automagic." + std::to_string(process);
+    }
+
+    static std::uint64_t Now () {
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()
+            ).count()
+        );
+    }
+};
+
+constexpr std::chrono::milliseconds LiveMetrics::c_interval;
+
+//--------------------------------------------------------------------------------------------------
+//  LivePublisher writes this process's LiveMetrics once Open has created the segment; until then
+//  every call returns straight away.
+//--------------------------------------------------------------------------------------------------
+struct LivePublisher {
+    std::unique_ptr<NamedSharedMemory> m_segment;
+    LiveMetrics* m_metrics{};
+    LiveMetrics::Version m_version{};
+    std::uint64_t m_published{};
+
+    static LivePublisher& Get () {
+        static LivePublisher s_publisher;
+        return s_publisher;
+    }
+
+    LivePublisher () = default;
+    LivePublisher (const LivePublisher&) = delete;
+    LivePublisher& operator= (const LivePublisher&) = delete;
+    ~LivePublisher () {
+        if (m_metrics)
+            m_metrics->m_finished.store(1, std::memory_order_release);
+    }
+
+    bool Open () {
+        m_segment = std::make_unique<NamedSharedMemory>(
+            LiveMetrics::NameOf(current_process_id()),
+            sizeof(LiveMetrics),
+            NamedSharedMemory::Access::Create
+        );
+        if (!m_segment->m_data)
+            return false;
+        m_metrics = new (m_segment->m_data) LiveMetrics;
+        return true;
+    }
+
+    void Begin (const char* label) {
+        if (!m_metrics)
+            return;
+        const auto ordinal = m_version.m_ordinal + 1;
+        m_version = {};
+        std::strncpy(m_version.m_label, label, sizeof(m_version.m_label) - 1);
+        m_version.m_ordinal = ordinal;
+        m_version.m_started = m_version.m_updated = LiveMetrics::Now();
+        m_metrics->m_version.Store(m_version);
+    }
+
+    void Update (const ProfileSummary& summary, bool force = false) {
+        if (!m_metrics)
+            return;
+        const auto now = LiveMetrics::Now();
+        const auto interval = std::chrono::nanoseconds{LiveMetrics::c_interval}.count();
+        if (!force && now - m_published < static_cast<std::uint64_t>(interval))
+            return;
+        m_published = now;
+        m_version.m_games = summary.m_count;
+        m_version.m_turns = summary.m_total.m_turnCount;
+        m_version.m_mean = summary.m_durations.Mean() / 1e6;
+        m_version.m_p99 = summary.m_durationSketch.Quantile(0.99);
+        m_version.m_updated = now;
+        m_metrics->m_version.Store(m_version);
+    }
+
+    // main keeps 'worker' below c_workerCount, so each worker only ever writes its own slot and
+    // reading it back is safe
+    void Worker (std::size_t worker, const ProfileInfo& info) {
+        if (!m_metrics)
+            return;
+        auto& slot = m_metrics->m_workers[worker];
+        LiveMetrics::Worker progress{};
+        (void)slot.Load(progress);
+        if (progress.m_ordinal != m_version.m_ordinal)
+            progress = {m_version.m_ordinal, 0, 0, 0};
+        ++progress.m_games;
+        progress.m_turns += info.m_turnCount;
+        progress.m_updated = LiveMetrics::Now();
+        slot.Store(progress);
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+//  WatchMetrics prints the live metrics of the profiler running as 'process' every second until
+//  it finishes: the version in progress with its games and turns per second over the last second,
+//  mean and p99 duration so far, and each worker's games, flagging any which hasn't finished one
+//  in c_stall. If the profiler dies first, it fails and removes the segment left behind.
+//--------------------------------------------------------------------------------------------------
+int WatchMetrics (std::uint64_t process) {
+    static const std::chrono::seconds c_stall{5};
+
+    const NamedSharedMemory segment(
+        LiveMetrics::NameOf(process), sizeof(LiveMetrics), NamedSharedMemory::Access::Read
     );
+    const auto* metrics = segment.As<const LiveMetrics>();
+    if (!segment.m_data ||
+        metrics->m_magic != LiveMetrics::c_magic ||
+        metrics->m_size != sizeof(LiveMetrics))
+    {
+        std::cerr << "Error: no live metrics for process " << process;
+        std::cerr << " (was it started with --live?)" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::uint64_t ordinal = 0;
+    std::uint64_t games = 0;
+    std::uint64_t turns = 0;
+    auto read = LiveMetrics::Now();
+    while (metrics->m_finished.load(std::memory_order_acquire) == 0) {
+        std::this_thread::sleep_for(std::chrono::seconds{1});
+        //  The profiler marks the metrics finished before it exits, so it died if it's gone first
+        if (!process_alive(process) && metrics->m_finished.load(std::memory_order_acquire) == 0) {
+            std::cerr << "Error: process " << process << " exited before it finished" << std::endl;
+            (void)NamedSharedMemory::Remove(LiveMetrics::NameOf(process));
+            return EXIT_FAILURE;
+        }
+        LiveMetrics::Version version;
+        if (!metrics->m_version.Load(version) || version.m_ordinal == 0)
+            continue;
+
+        //  Shard processes only merge their summaries when they finish, so count from the workers
+        LiveMetrics::Worker workers[LiveMetrics::c_workerCount];
+        std::uint64_t workerGames = 0;
+        std::uint64_t workerTurns = 0;
+        for (std::size_t i = 0; i < LiveMetrics::c_workerCount; ++i) {
+            auto& w = workers[i];
+            if (!metrics->m_workers[i].Load(w) || w.m_ordinal != version.m_ordinal)
+                w = {};
+            workerGames += w.m_games;
+            workerTurns += w.m_turns;
+        }
+        const auto now = LiveMetrics::Now();
+        if (version.m_ordinal != ordinal) {
+            ordinal = version.m_ordinal;
+            games = turns = 0;
+            read = version.m_started;
+        }
+        const auto seconds = 1e-9 * (now - read);
+        std::cout << version.m_label << " Games: " << workerGames;
+        std::cout << " (" << (workerGames - games) / seconds << "/s)";
+        std::cout << " Turns/s: " << (workerTurns - turns) / seconds;
+        if (version.m_games > 0)
+            std::cout << " Avg: " << version.m_mean << "ms P99: " << version.m_p99 << "ms";
+        games = workerGames;
+        turns = workerTurns;
+        read = now;
+
+        const auto stall = static_cast<std::uint64_t>(std::chrono::nanoseconds{c_stall}.count());
+        for (std::size_t i = 0; i < LiveMetrics::c_workerCount; ++i) {
+            if (workers[i].m_games == 0)
+                continue;
+            std::cout << " W" << i << ": " << workers[i].m_games;
+            if (now - workers[i].m_updated > stall)
+                std::cout << " STALLED " << (now - workers[i].m_updated) / 1000000000 << "s";
+        }
+        std::cout << std::endl;
+    }
+    std::cout << "Finished" << std::endl;
+    return 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  GameBatch holds a batch of games in a PageArena with one page aligned slice per worker. Each
+//  worker constructs, plays and destroys only the games in its own slice, so the pages it first
+//  touches (and the NUMA node the kernel places them on) are its own.
+//--------------------------------------------------------------------------------------------------
+template <typename G>
+struct GameBatch {
+    PageArena m_arena;
+    std::vector<G*> m_slices;
+    std::size_t m_gamesPerSlice{};
+    std::vector<std::size_t> m_cpus;
+    bool m_reuse{};
+    std::vector<std::size_t> m_constructed;     // Per slice, games kept for Reset when m_reuse
+
+    explicit GameBatch (const ProfileOptions& options) :
+        m_cpus(options.m_cpus),
+        m_reuse(options.m_reuseGames)
+    {
+        const auto threads = std::min(options.m_threadCount, options.m_batchSize);
+        m_gamesPerSlice = (options.m_batchSize + threads - 1) / threads;
+        const auto sliceBytes = [&] (std::size_t pageSize) {
+            return PageArena::RoundUp(m_gamesPerSlice * sizeof(G), pageSize);
+        };
+        m_arena.Map(sliceBytes(PageArena::c_hugePageSize) * threads, options.m_pageMode);
+        for (std::size_t i = 0; i < threads; ++i) {
+            const auto bytes = sliceBytes(m_arena.m_pageSize);
+            m_slices.push_back(static_cast<G*>(m_arena.Allocate(bytes, m_arena.m_pageSize)));
+        }
+        m_constructed.resize(threads);
+    }
+    GameBatch (const GameBatch&) = delete;
+    GameBatch& operator= (const GameBatch&) = delete;
+    ~GameBatch () {
+        for (std::size_t slice = 0; slice < m_slices.size(); ++slice) {
+            for (std::size_t i = 0; i < m_constructed[slice]; ++i)
+                m_slices[slice][i].~G();
+        }
+    }
+
+    void Play (
+        const ProfileOptions& options,
+        std::size_t firstRun,
+        ProfileInfo* info,
+        std::size_t count
+    ) {
+        const auto& worker = [&] (std::size_t slice) {
+            if (slice > 0 && !m_cpus.empty())
+                (void)pin_current_thread(m_cpus[slice % m_cpus.size()]);
+            const auto first = slice * m_gamesPerSlice;
+            const auto last = std::min(first + m_gamesPerSlice, count);
+            auto* games = m_slices[slice];
+            auto& constructed = m_constructed[slice];
+            for (auto i = first; i < last; ++i) {
+                auto& game = games[i - first];
+                const auto seed = options.SeedFor(firstRun + i);
+                if (i - first < constructed) {
+                    AUTOMAGIC_TRACE_SCOPE("Reset");
+                    timed_call<TscClock>(info[i].m_setup, [&game, seed] { game.Reset(seed); });
+                }
+                else {
+                    AUTOMAGIC_TRACE_SCOPE("Construct");
+                    timed_call<TscClock>(
+                        info[i].m_setup,
+                        [&game, seed] { SeedGame(*new (&game) G{}, seed); }
+                    );
+                }
+            }
+            for (auto i = first; i < last; ++i) {
+                AUTOMAGIC_TRACE_SCOPE("Run");
+                auto& game = games[i - first];
+                info[i].m_turnCount = timed_call<TscClock>(info[i].m_play, &PlayTurns<G>, game);
+                info[i].m_duration = std::chrono::duration_cast<ProfileInfo::Duration>(
+                    info[i].m_setup + info[i].m_play
+                );
+                LivePublisher::Get().Worker(slice, info[i]);
+                if (!m_reuse)
+                    game.~G();
+            }
+            if (m_reuse)
+                constructed = std::max(constructed, last - std::min(first, last));
+        };
+
+        std::vector<std::thread> threads;
+        for (std::size_t i = 1; i < m_slices.size(); ++i)
+            threads.emplace_back(worker, i);
+        worker(0);
+        for (auto& t : threads)
+            t.join();
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+//  PlayShards splits 'count' runs between worker processes, each of which folds its runs into a
+//  ProfileSummary of its own in a shared segment, along with the index of its next run, which is
+//  advanced before each game is played. A shard whose process dies is resumed by a new process
+//  from that index, so a crash only loses the game in progress, even one which crashes every time.
+//  The shards' summaries are merged into 'summary'; the number of runs lost is returned.
+//--------------------------------------------------------------------------------------------------
+struct ShardRecord {
+    ProfileSummary m_summary;
+    std::size_t m_next{};
+};
+
+template <typename F>
+std::size_t PlayShards (
+    const ProfileOptions& options,
+    std::size_t firstRun,
+    std::size_t count,
+    const F& profile,
+    ProfileSummary& summary
+) {
+    static const std::size_t c_retries = 2;
+
+    const auto shards = std::min(options.m_processCount, count);
+    auto bytes = sizeof(ShardRecord) * shards;
+#if AUTOMAGIC_SPELL_STATS
+    const auto spellsOffset = PageArena::RoundUp(bytes, alignof(SpellCounterArray));
+    bytes = spellsOffset + sizeof(SpellCounterArray) * shards;
+#endif
+    SharedMemory segment(bytes);
+    auto* records = new (segment.m_data) ShardRecord[shards];
+    for (std::size_t i = 0; i < shards; ++i)
+        records[i].m_next = i;
+#if AUTOMAGIC_SPELL_STATS
+    auto* spells = new (segment.As<void>(spellsOffset)) SpellCounterArray[shards];
+#endif
+
+    const auto failed = fork_shards(shards, c_retries, [&] (std::size_t shard) {
+        if (!options.m_cpus.empty())
+            (void)pin_current_thread(options.m_cpus[shard % options.m_cpus.size()]);
+        auto& record = records[shard];
+        while (record.m_next < count) {
+            //  Claimed before playing, so a retry skips (and loses) a game which crashes
+            const auto run = record.m_next;
+            record.m_next += shards;
+            ProfileInfo info;
+            profile(info, options.SeedFor(firstRun + run));
+            record.m_summary.Add(info);
+            LivePublisher::Get().Worker(shard, info);
+        }
+#if AUTOMAGIC_SPELL_STATS
+        spells[shard] = collect_spell_stats();
+#endif
+        return true;
+    });
+
+    const auto before = summary.m_count;
+    for (std::size_t i = 0; i < shards; ++i)
+        summary.Merge(records[i].m_summary);
+#if AUTOMAGIC_SPELL_STATS
+    for (std::size_t i = 0; i < shards; ++i)
+        SpellStatsLog::Get().Merge(spells[i]);
+#endif
+    if (!failed.empty())
+        std::cerr << "Warning: " << failed.size() << " shard(s) failed after retries" << std::endl;
+    return count - std::min(count, summary.m_count - before);
+}
+
+//--------------------------------------------------------------------------------------------------
+//  FailedChecks counts the correctness checks (golden outputs, allocation free turns) which have
+//  failed, so that main can fail the process once every version has been profiled.
+//--------------------------------------------------------------------------------------------------
+std::size_t& FailedChecks () {
+    static std::size_t s_count;
+    return s_count;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  GameFingerprint identifies how a game played out: its turn count, a hash of its life after every
+//  turn (so two games which end alike by different routes still differ) and its final life.
+//--------------------------------------------------------------------------------------------------
+struct GameFingerprint {
+    ProfileInfo::TurnCount m_turnCount{};
+    std::uint64_t m_traceHash{14695981039346656037ull};   // FNV-1a offset basis
+    std::uint64_t m_finalHash{14695981039346656037ull};
+
+    template <typename T>
+    static void Hash (std::uint64_t& hash, const T& t) {
+        static_assert(std::is_trivially_copyable<T>::value, "Hashes the object representation");
+        const auto* bytes = reinterpret_cast<const unsigned char*>(&t);
+        for (std::size_t i = 0; i < sizeof(T); ++i)
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+
+    template <typename G>
+    static GameFingerprint Play (std::uint32_t seed) {
+        GameFingerprint fingerprint;
+        G game{};
+        SeedGame(game, seed);
+        while (game.Turn()) {
+            ++fingerprint.m_turnCount;
+            Hash(fingerprint.m_traceHash, game.m_life);
+        }
+        Hash(fingerprint.m_finalHash, game.m_life);
+        return fingerprint;
+    }
+
+    bool operator== (const GameFingerprint& other) const {
+        return m_turnCount == other.m_turnCount &&
+            m_traceHash == other.m_traceHash &&
+            m_finalHash == other.m_finalHash;
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+//  GoldenOutputs keeps the fingerprints of the first version profiled in each family ("V3.0" and
+//  "V3.2" are both family "V3"; "V3.1/16" is family "V3/16"; anything after a space only describes
+//  the version) as the golden output which every later member must reproduce seed for seed.
+//  With --game-threads each seed is also played on one thread, as a game split between threads
+//  must play just as it does on one (otherwise a lone parallel version would go unchecked).
+//  A divergence is reported on stderr and fails the process.
+//--------------------------------------------------------------------------------------------------
+struct GoldenOutputs {
+    struct Family {
+        std::string m_reference;
+        std::vector<GameFingerprint> m_fingerprints;
+    };
+
+    std::map<std::string, Family> m_families;
+
+    static GoldenOutputs& Get () {
+        static GoldenOutputs s_outputs;
+        return s_outputs;
+    }
+
+    static std::string FamilyOf (const std::string& label) {
+        const auto name = label.substr(0, label.find(' '));
+        const auto dot = name.find('.');
+        if (dot == std::string::npos)
+            return name;
+        const auto end = name.find_first_not_of("0123456789", dot + 1);
+        return name.substr(0, dot) + (end == std::string::npos ? "" : name.substr(end));
+    }
+
+    // Returns a one line verdict for the profile output
+    template <typename G>
+    std::string Verify (const char* label, const ProfileOptions& options) {
+        std::vector<GameFingerprint> fingerprints;
+        for (std::size_t i = 0; i < options.m_verifySeeds; ++i)
+            fingerprints.push_back(GameFingerprint::Play<G>(options.SeedFor(i)));
+
+        auto& parallel = ParallelFor::Get();
+        const auto threads = parallel.ThreadCount();
+        std::string alike;
+        if (threads > 1) {
+            parallel.Resize(1);
+            std::size_t i = 0;
+            while (i < fingerprints.size() &&
+                GameFingerprint::Play<G>(options.SeedFor(i)) == fingerprints[i])
+            {
+                ++i;
+            }
+            parallel.Resize(threads);
+            if (i < fingerprints.size()) {
+                ++FailedChecks();
+                std::cerr << "Error: " << label << " plays seed " << options.SeedFor(i);
+                std::cerr << " differently on " << threads << " threads than on 1" << std::endl;
+                return "DIVERGES on " + std::to_string(threads) + " threads from 1";
+            }
+            alike = ", alike on 1 and " + std::to_string(threads) + " threads";
+        }
+
+        auto& family = m_families[FamilyOf(label)];
+        if (family.m_reference.empty()) {
+            family.m_reference = label;
+            family.m_fingerprints = std::move(fingerprints);
+            return "reference for " + FamilyOf(label) + alike;
+        }
+
+        const auto seeds = std::min(fingerprints.size(), family.m_fingerprints.size());
+        for (std::size_t i = 0; i < seeds; ++i) {
+            const auto& expected = family.m_fingerprints[i];
+            const auto& actual = fingerprints[i];
+            if (actual == expected)
+                continue;
+            ++FailedChecks();
+            std::cerr << "Error: " << label << " diverges from " << family.m_reference;
+            std::cerr << " with seed " << options.SeedFor(i) << ": turns " << actual.m_turnCount;
+            std::cerr << " vs " << expected.m_turnCount;
+            std::cerr << std::hex;
+            std::cerr << ", trace " << actual.m_traceHash << " vs " << expected.m_traceHash;
+            std::cerr << ", final " << actual.m_finalHash << " vs " << expected.m_finalHash;
+            std::cerr << std::dec << std::endl;
+            return "DIVERGES from " + family.m_reference;
+        }
+        return "matches " + family.m_reference + alike;
+    }
+};
+
+#if AUTOMAGIC_ALLOCATION_STATS
+//--------------------------------------------------------------------------------------------------
+//  TurnAllocations plays one game, attributing the allocations it makes to its construction, its
+//  first turn (where any function-local statics are initialized) and all of its later turns.
+//  Later turns must not allocate at all (except for the trace's own buffers when AUTOMAGIC_TRACE
+//  is enabled, which only draws a warning).
+//--------------------------------------------------------------------------------------------------
+struct TurnAllocations {
+    AllocationCounters::Snapshot m_construct;
+    AllocationCounters::Snapshot m_firstTurn;
+    AllocationCounters::Snapshot m_laterTurns;
+
+    template <typename G>
+    static TurnAllocations Check (std::uint32_t seed) {
+        auto& counters = AllocationCounters::Get();
+        TurnAllocations allocations;
+
+        const auto start = counters.Take();
+        G game{};
+        SeedGame(game, seed);
+        const auto constructed = counters.Take();
+        auto alive = game.Turn();
+        const auto firstTurn = counters.Take();
+        while (alive)
+            alive = game.Turn();
+        const auto end = counters.Take();
+
+        allocations.m_construct = constructed - start;
+        allocations.m_firstTurn = firstTurn - constructed;
+        allocations.m_laterTurns = end - firstTurn;
+        return allocations;
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+void OutputAllocations (
+    const char* label,
+    const TurnAllocations& turns,
+    const AllocationCounters::Snapshot& version,
+    std::size_t runCount,
+    std::size_t peakResident
+) {
+    std::cout << "Allocs Version: " << version.m_allocations << " (" << version.m_bytes << "B)";
+    if (runCount > 0)
+        std::cout << " Per Game: " << static_cast<double>(version.m_allocations) / runCount;
+    std::cout << " Peak RSS: " << peakResident / 1024 << "KB" << std::endl;
+    std::cout << "Allocs Construct: " << turns.m_construct.m_allocations;
+    std::cout << " First Turn: " << turns.m_firstTurn.m_allocations;
+    std::cout << " Later Turns: " << turns.m_laterTurns.m_allocations << std::endl;
+    if (turns.m_laterTurns.m_allocations > 0) {
+#if AUTOMAGIC_TRACE
+        std::cerr << "Warning (tracing allocates): " << label;
+#else
+        ++FailedChecks();
+        std::cerr << "Error: " << label;
+#endif
+        std::cerr << " allocated " << turns.m_laterTurns.m_allocations;
+        std::cerr << " times (" << turns.m_laterTurns.m_bytes << "B) after its first turn";
+        std::cerr << std::endl;
+    }
+}
+#endif
+
+//--------------------------------------------------------------------------------------------------
+//  ProfileColdStart compares the latency of a game's first turn with that of the turns which
+//  follow it. Each sample is played by a newly forked process, so its first turn pays whatever a
+//  freshly spawned worker would: static initialization, page faults and cold caches. The steady
+//  state is the mean of the next c_steadyTurns turns, or fewer if the game ends first.
+//  (Without fork the samples share this process and only the very first is cold.)
+//--------------------------------------------------------------------------------------------------
+struct ColdStartRecord {
+    TscClock::duration m_first{};
+    TscClock::duration m_steady{};
+    ProfileInfo::TurnCount m_steadyTurns{};
+    bool m_complete{};
+};
+
+template <typename G>
+void ProfileColdStart (const char* label, const ProfileOptions& options) {
+    static const ProfileInfo::TurnCount c_steadyTurns = 1000;
+
+    const auto count = options.m_runCount;
+    SharedMemory segment(sizeof(ColdStartRecord) * count);
+    auto* records = new (segment.m_data) ColdStartRecord[count]();
+
+    for (std::size_t i = 0; i < count; ++i) {
+        (void)fork_shards(1, 0, [&] (std::size_t) {
+            if (!options.m_cpus.empty())
+                (void)pin_current_thread(options.m_cpus.front());
+            G game{};
+            SeedGame(game, options.SeedFor(i));
+
+            auto& record = records[i];
+            auto alive = timed_call<TscClock>(record.m_first, [&game] { return game.Turn(); });
+            record.m_steady = TscClock::duration::zero();
+            record.m_steadyTurns = 0;
+            while (alive && record.m_steadyTurns < c_steadyTurns) {
+                TscClock::duration duration;
+                alive = timed_call<TscClock>(duration, [&game] { return game.Turn(); });
+                record.m_steady += duration;
+                ++record.m_steadyTurns;
+            }
+            record.m_complete = true;
+            return true;
+        });
+    }
+
+    RunningStatistics first;
+    RunningStatistics steady;
+    auto firstMinimum = std::numeric_limits<double>::max();
+    auto steadyMinimum = std::numeric_limits<double>::max();
+    std::size_t lostCount = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto& record = records[i];
+        if (!record.m_complete) {
+            ++lostCount;
+            continue;
+        }
+        const auto f = static_cast<double>(record.m_first.count());
+        first.Add(f);
+        firstMinimum = std::min(firstMinimum, f);
+        if (record.m_steadyTurns > 0) {
+            const auto s = static_cast<double>(record.m_steady.count()) / record.m_steadyTurns;
+            steady.Add(s);
+            steadyMinimum = std::min(steadyMinimum, s);
+        }
+    }
+
+    static const auto& output = [] (const char* label, const auto& stats, double minimum) {
+        std::cout << label << " Avg: " << stats.Mean() << "ns";
+        std::cout << " Min: " << minimum << "ns";
+        std::cout << " CI95: +/-" << 100.0 * relative_confidence_95(stats) << "%" << std::endl;
+    };
 
     std::cout << label << std::endl;
-    output(summary.m_average, "Tot");
-    summary.m_average.m_duration /= info.size();
-    summary.m_average.m_turnCount /= info.size();
-    output(summary.m_maximum, "Max");
-    output(summary.m_average, "Avg");
-    output(summary.m_minimum, "Min");
+    std::cout << "Cold Samples: " << first.m_count << " Lost: " << lostCount << std::endl;
+    if (first.m_count > 0 && steady.m_count > 0) {
+        output("First", first, firstMinimum);
+        output("Steady", steady, steadyMinimum);
+        std::cout << "Ratio: " << first.Mean() / steady.Mean() << std::endl;
+    }
     std::cout << std::endl;
 }
 
 //--------------------------------------------------------------------------------------------------
-int main () {
-    static const struct {
-        void (*m_function)(const char*);
-        const char* m_label;
-    } c_games[] = {
+template <typename G>
+void ProfileGame (const char* label, const ProfileOptions& options) {
+    AUTOMAGIC_TRACE_SCOPE(label);
+    if (options.m_coldStart)
+        return ProfileColdStart<G>(label, options);
+#if AUTOMAGIC_ALLOCATION_STATS
+    const auto turnAllocations = TurnAllocations::Check<G>(options.SeedFor(0));
+#endif
+    const auto verdict = options.m_verifySeeds > 0 ?
+        GoldenOutputs::Get().Verify<G>(label, options) :
+        std::string();
+#if AUTOMAGIC_ALLOCATION_STATS
+    (void)reset_peak_resident();
+    const auto versionStart = AllocationCounters::Get().Take();
+#endif
+
+    const auto& profile = [&options] (auto& i, std::uint32_t seed) {
+        i = PlayOnce<G>(seed, options.m_reuseGames);
+    };
+    if (options.m_reuseGames)
+        GamePool<G>::Get().Warm(1);
+
+#if AUTOMAGIC_SPELL_STATS
+    (void)collect_spell_stats();
+#endif
+    ProfileSummary summary;
+    auto& live = LivePublisher::Get();
+    live.Begin(label);
+    const auto start = std::chrono::steady_clock::now();
+    const auto& finished = [&] {
+        if (!options.m_adaptive)
+            return summary.m_count >= options.m_runCount;
+        if (summary.m_count < options.m_minimumRuns)
+            return false;
+        return relative_confidence_95(summary.m_durations) <= options.m_targetPrecision ||
+            summary.m_count >= options.m_maximumRuns ||
+            std::chrono::steady_clock::now() - start >= options.m_timeBudget;
+    };
+    PerfCounters counters;
+    if (options.m_perfCounters)
+        counters.Start();
+    std::unique_ptr<GameBatch<G>> batch;
+    std::vector<ProfileInfo> round;
+    if (options.m_batchSize > 0) {
+        batch = std::make_unique<GameBatch<G>>(options);
+        round.resize(options.m_batchSize);
+    }
+    std::size_t runCount = 0;
+    std::size_t lostCount = 0;
+    while (!finished()) {
+        if (options.m_processCount > 1) {
+            const auto first = summary.m_count;
+            const auto count = options.m_adaptive ? options.m_processCount : options.m_runCount;
+            lostCount += PlayShards(options, runCount, count, profile, summary);
+            runCount += count;
+            if (summary.m_count == first || !options.m_adaptive)
+                break;      // Lost runs aren't made up with more runs
+        }
+        else if (batch) {
+            //  The last round only plays the runs left, so neither limit is overshot
+            const auto limit = options.m_adaptive ? options.m_maximumRuns : options.m_runCount;
+            const auto count = std::min(round.size(), limit - std::min(limit, summary.m_count));
+            batch->Play(options, runCount, round.data(), count);
+            for (std::size_t i = 0; i < count; ++i)
+                summary.Add(round[i]);
+            runCount += count;
+        }
+        else {
+            ProfileInfo info;
+            profile(info, options.SeedFor(runCount));
+            summary.Add(info);
+            live.Worker(0, info);
+            ++runCount;
+        }
+        live.Update(summary);
+    }
+    live.Update(summary, true);
+    const auto perfValues = counters.Stop();
+#if AUTOMAGIC_SPELL_STATS
+    const auto spellStats = collect_spell_stats();
+#endif
+#if AUTOMAGIC_ALLOCATION_STATS
+    const auto versionAllocations = AllocationCounters::Get().Take() - versionStart;
+    const auto peakResident = peak_resident_bytes();
+#endif
+
+    std::cout << label << std::endl;
+    std::cout << "Runs: " << summary.m_count;
+    std::cout << " CI95: +/-" << 100.0 * relative_confidence_95(summary.m_durations) << "%";
+    if (options.m_processCount > 1) {
+        std::cout << " Processes: " << options.m_processCount;
+        std::cout << " Lost: " << lostCount;
+    }
+    else if (batch) {
+        static const char* const c_pageModes[] = { "none", "thp", "explicit", };
+        std::cout << " Batch: " << options.m_batchSize;
+        std::cout << " Threads: " << batch->m_slices.size();
+        std::cout << " Pages: " << c_pageModes[static_cast<int>(batch->m_arena.m_mode)];
+    }
+    std::cout << std::endl;
+    if (!verdict.empty())
+        std::cout << "Verify: " << options.m_verifySeeds << " seeds " << verdict << std::endl;
+    if (summary.m_count == 0) {
+        std::cout << std::endl;
+        return;
+    }
+    OutputSummary(summary);
+    if (options.m_perfCounters)
+        OutputPerfCounters(counters, perfValues);
+#if AUTOMAGIC_SPELL_STATS
+    OutputSpellStats(spellStats);
+#endif
+#if AUTOMAGIC_ALLOCATION_STATS
+    OutputAllocations(label, turnAllocations, versionAllocations, summary.m_count, peakResident);
+#endif
+    std::cout << std::endl;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  ResultCache keeps the report of each version profiled with --cache in AUTOMAGIC_CACHE_FILE,
+//  keyed by everything the report depends on: the compiler, the build flags (those passed in
+//  AUTOMAGIC_BUILD_FLAGS), the CPU, the profile options and the version itself. A version whose
+//  key is unchanged prints its cached report rather than playing again, so iterating on one family
+//  only re-runs that family.
+//  The source isn't available at run time, so a version is identified by its type, its size, how
+//  it plays the first seed and the sizes of its compiled functions: with symbols, every function
+//  whose mangled name mentions the version's type, otherwise just its turn loop. A change which
+//  keeps all of those the same goes unnoticed; delete the file to start afresh.
+//--------------------------------------------------------------------------------------------------
+struct ResultCache {
+    std::map<std::uint64_t, std::string> m_reports;
+
+    static ResultCache& Get () {
+        static ResultCache s_cache;
+        return s_cache;
+    }
+
+    static void Hash (std::uint64_t& hash, const std::string& s) {
+        for (const auto c : s)
+            GameFingerprint::Hash(hash, c);
+    }
+
+    template <typename G>
+    static std::uint64_t Identify (const ProfileOptions& options) {
+        std::uint64_t hash{14695981039346656037ull};
+        Hash(hash, typeid(G).name());
+        GameFingerprint::Hash(hash, sizeof(G));
+        GameFingerprint::Hash(hash, function_size(reinterpret_cast<const void*>(&PlayTurns<G>)));
+
+        //  Itanium type names are "N...E" for nested names, whose functions are "N..." + member
+        std::string type = typeid(G).name();
+        if (!type.empty() && type.front() == 'N' && type.back() == 'E')
+            type.pop_back();
+        std::uint64_t functions = 0;     // Symbols are in address order, so sum them
+        for (const auto& symbol : code_symbols()) {
+            if (symbol.m_name.find(type) == std::string::npos)
+                continue;
+            std::uint64_t function{14695981039346656037ull};
+            Hash(function, symbol.m_name);
+            GameFingerprint::Hash(function, symbol.m_size);
+            functions += function;
+        }
+        GameFingerprint::Hash(hash, functions);
+        const auto played = GameFingerprint::Play<G>(options.SeedFor(0));
+        GameFingerprint::Hash(hash, played.m_turnCount);
+        GameFingerprint::Hash(hash, played.m_traceHash);
+        return hash;
+    }
+
+    // The compiler, build flags and CPU
+    static std::string Machine () {
+        std::ostringstream build;
+#if defined(_MSC_FULL_VER)
+        build << "msvc " << _MSC_FULL_VER;
+#elif defined(__VERSION__)
+        build << __VERSION__;
+#endif
+#if defined(__OPTIMIZE__)
+        build << " optimize";
+#endif
+#if defined(NDEBUG)
+        build << " ndebug";
+#endif
+#if defined(__AVX512F__)
+        build << " avx512f";
+#endif
+#if defined(__AVX2__)
+        build << " avx2";
+#endif
+#if defined(__FAST_MATH__)
+        build << " fast-math";
+#endif
+        build << " flags " << AUTOMAGIC_BUILD_FLAGS;
+        build << " stats " << AUTOMAGIC_SPELL_STATS << " trace " << AUTOMAGIC_TRACE;
+        build << " allocations " << AUTOMAGIC_ALLOCATION_STATS;
+        build << " cpu " << capture_environment().m_cpuModel;
+        return build.str();
+    }
+
+    // The part of every key which doesn't depend on the version
+    static std::uint64_t Build (const ProfileOptions& options) {
+        std::ostringstream build;
+        build << Machine();
+
+        const auto& o = options;
+        build << " runs " << o.m_runCount << " adaptive " << o.m_adaptive;
+        build << " " << o.m_targetPrecision << " " << o.m_minimumRuns << " " << o.m_maximumRuns;
+        build << " " << o.m_timeBudget.count() << " batch " << o.m_batchSize;
+        build << " threads " << o.m_threadCount << " pages " << static_cast<int>(o.m_pageMode);
+        build << " perf " << o.m_perfCounters << " pin " << o.m_pin;
+        build << " priority " << o.m_raisePriority << " mlock " << o.m_lockMemory << " cpus";
+        for (const auto cpu : o.m_cpus)
+            build << " " << cpu;
+        build << " processes " << o.m_processCount << " seed " << o.m_seed;
+        build << " vary " << o.m_varySeeds << " cold " << o.m_coldStart;
+        build << " verify " << o.m_verifySeeds << " reuse " << o.m_reuseGames;
+        build << " game threads " << o.m_gameThreads;
+
+        std::uint64_t hash{14695981039346656037ull};
+        Hash(hash, build.str());
+        return hash;
+    }
+
+    ResultCache () {
+        std::ifstream file(AUTOMAGIC_CACHE_FILE, std::ios::binary);
+        std::uint64_t key;
+        std::size_t length;
+        while (file >> std::hex >> key >> std::dec >> length && file.get() == '\n') {
+            std::string report(length, '\0');
+            if (!file.read(&report[0], length))
+                break;
+            m_reports[key] = std::move(report);
+        }
+    }
+
+    const std::string* Find (std::uint64_t key) const {
+        const auto i = m_reports.find(key);
+        return i != std::end(m_reports) ? &i->second : nullptr;
+    }
+
+    // Written aside and renamed into place, so concurrent runs never see a partial file
+    void Store (std::uint64_t key, std::string report) {
+        m_reports[key] = std::move(report);
+        const auto temporary = std::string(AUTOMAGIC_CACHE_FILE) + "." +
+            std::to_string(current_process_id());
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            for (const auto& i : m_reports) {
+                file << std::hex << i.first << std::dec << " " << i.second.size() << "\n";
+                file << i.second;
+            }
+            if (!file.flush())
+                return (void)std::remove(temporary.c_str());
+        }
+        if (!replace_file(temporary, AUTOMAGIC_CACHE_FILE))
+            (void)std::remove(temporary.c_str());
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+//  SplitsTurns is true of the versions which play each turn through ParallelFor, the only ones
+//  --game-threads affects.
+//--------------------------------------------------------------------------------------------------
+template <typename G>
+struct SplitsTurns : std::false_type { };
+
+template <typename L, std::size_t N>
+struct SplitsTurns<Version4_2::Game<L, N>> : std::true_type { };
+
+//--------------------------------------------------------------------------------------------------
+struct ProfiledVersion {
+    void (*m_profile)(const char*, const ProfileOptions&);
+    ProfileInfo (*m_play)(std::uint32_t, bool);
+    std::uint64_t (*m_identify)(const ProfileOptions&);
+    std::string (*m_verify)(const char*, const ProfileOptions&);
+    const char* m_label;
+    bool m_splitsTurns;
+
+    template <typename G>
+    static std::string Verify (const char* label, const ProfileOptions& options) {
+        return GoldenOutputs::Get().Verify<G>(label, options);
+    }
+
+    template <typename G>
+    static constexpr ProfiledVersion Of (const char* label) {
+        return {
+            &ProfileGame<G>, &PlayOnce<G>, &ResultCache::Identify<G>, &Verify<G>, label,
+            SplitsTurns<G>::value,
+        };
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+//  ProfileCached profiles a version, or with options.m_useCache prints its cached report if it
+//  has one. Cached versions are still verified so the rest of their family has its reference.
+//  Reports of versions which fail a check aren't cached.
+//--------------------------------------------------------------------------------------------------
+void ProfileCached (const ProfiledVersion& version, const ProfileOptions& options) {
+    if (!options.m_useCache)
+        return version.m_profile(version.m_label, options);
+
+    static const auto s_build = ResultCache::Build(options);
+    auto key = s_build;
+    ResultCache::Hash(key, version.m_label);
+    GameFingerprint::Hash(key, version.m_identify(options));
+
+    auto& cache = ResultCache::Get();
+    if (const auto* report = cache.Find(key)) {
+        if (options.m_verifySeeds > 0 && !options.m_coldStart)
+            (void)version.m_verify(version.m_label, options);
+        const auto label = report->find('\n') + 1;
+        std::cout << report->substr(0, label);
+        std::cout << "Cached: " << std::hex << key << std::dec << std::endl;
+        std::cout << report->substr(label) << std::flush;
+        return;
+    }
+
+    const auto failed = FailedChecks();
+    std::ostringstream report;
+    auto* const buffer = std::cout.rdbuf(report.rdbuf());
+    version.m_profile(version.m_label, options);
+    std::cout.rdbuf(buffer);
+    std::cout << report.str() << std::flush;
+    if (FailedChecks() == failed)
+        cache.Store(key, report.str());
+}
+
+//--------------------------------------------------------------------------------------------------
+//  TuningVariant is a ProfiledVersion which TunedVersion can choose between. TurnCost returns the
+//  nanoseconds per turn over c_turns turns from 'seed' (the best of c_repeats); RoundCost the
+//  nanoseconds per turn over a round of options.m_batchSize games, or of c_unbatchedGames games
+//  played one at a time if that's 0. Both are timed with TscClock, as the runs themselves are.
+//--------------------------------------------------------------------------------------------------
+struct TuningVariant {
+    ProfiledVersion m_version;
+    double (*m_turnCost)(std::uint32_t);
+    double (*m_roundCost)(const ProfileOptions&);
+
+    template <typename G>
+    static double TurnCost (std::uint32_t seed) {
+        static const std::size_t c_turns = std::size_t{1} << 18;
+        static const std::size_t c_repeats = 3;
+
+        auto best = std::numeric_limits<double>::infinity();
+        for (std::size_t r = 0; r < c_repeats; ++r) {
+            G game{};
+            SeedGame(game, seed);
+            std::chrono::duration<double, std::nano> elapsed;
+            timed_call<TscClock>(elapsed, [&game, &seed] {
+                for (std::size_t t = 0; t < c_turns; ++t) {
+                    if (!game.Turn())
+                        game.Reset(++seed);
+                }
+            });
+            best = std::min(best, elapsed.count() / c_turns);
+        }
+        return best;
+    }
+
+    template <typename G>
+    static double RoundCost (const ProfileOptions& options) {
+        static const std::size_t c_unbatchedGames = 4;
+
+        ProfileInfo::TurnCount turns = 0;
+        std::chrono::duration<double, std::nano> elapsed;
+        timed_call<TscClock>(elapsed, [&options, &turns] {
+            if (options.m_batchSize == 0) {
+                for (std::size_t i = 0; i < c_unbatchedGames; ++i)
+                    turns += PlayOnce<G>(options.SeedFor(i), options.m_reuseGames).m_turnCount;
+            }
+            else {
+                GameBatch<G> batch(options);
+                std::vector<ProfileInfo> round(options.m_batchSize);
+                batch.Play(options, 0, round.data(), round.size());
+                for (const auto& i : round)
+                    turns += i.m_turnCount;
+            }
+        });
+        return elapsed.count() / std::max<ProfileInfo::TurnCount>(turns, 1);
+    }
+
+    template <typename G>
+    static constexpr TuningVariant Of (const char* label) {
+        return {ProfiledVersion::Of<G>(label), &TurnCost<G>, &RoundCost<G>};
+    }
+};
+
+// Variants with other engines play other games, so they are families of their own
+static const TuningVariant c_tuningVariants[] = {
+    TuningVariant::Of<
+        Version3_3::Game<unsigned int, std::mt19937, Version3_3::MemberPointer>
+    >("V3.3 member"),
+    TuningVariant::Of<
+        Version3_3::Game<unsigned int, std::mt19937, Version3_3::FunctionPointer>
+    >("V3.3 function"),
+    TuningVariant::Of<
+        Version3_3::Game<unsigned int, std::mt19937, Version3_3::Switch>
+    >("V3.3 switch"),
+    TuningVariant::Of<
+        Version3_3::Game<unsigned int, std::minstd_rand, Version3_3::MemberPointer>
+    >("V3.3/minstd member"),
+    TuningVariant::Of<
+        Version3_3::Game<unsigned int, std::minstd_rand, Version3_3::FunctionPointer>
+    >("V3.3/minstd function"),
+    TuningVariant::Of<
+        Version3_3::Game<unsigned int, std::minstd_rand, Version3_3::Switch>
+    >("V3.3/minstd switch"),
+    TuningVariant::Of<
+        Version3_3::Game<unsigned int, SplitMix64, Version3_3::MemberPointer>
+    >("V3.3/splitmix member"),
+    TuningVariant::Of<
+        Version3_3::Game<unsigned int, SplitMix64, Version3_3::FunctionPointer>
+    >("V3.3/splitmix function"),
+    TuningVariant::Of<
+        Version3_3::Game<unsigned int, SplitMix64, Version3_3::Switch>
+    >("V3.3/splitmix switch"),
+};
+
+//--------------------------------------------------------------------------------------------------
+//  TunedVersion stands in for whichever of c_tuningVariants plays fastest on this machine, profiled
+//  only with --tune. Tune picks the variant by TurnCost, then a batch width by the winner's
+//  RoundCost for each of c_gamesPerThread, and saves both choices in AUTOMAGIC_TUNING_FILE keyed by
+//  the build, CPU and thread count; later runs reuse them without measuring unless
+//  options.m_retune. The width only applies when neither a batch nor processes were asked for.
+//  A winner with another engine plays another game from the rest of the versions, so it is
+//  verified against its untuned siblings (the variants with the same engine) instead.
+//--------------------------------------------------------------------------------------------------
+struct TunedVersion {
+    const TuningVariant* m_variant{&c_tuningVariants[0]};
+    std::size_t m_batchSize{};
+    std::string m_label{m_variant->m_version.m_label};
+
+    static TunedVersion& Get () {
+        static TunedVersion s_tuned;
+        return s_tuned;
+    }
+
+    void Tune (const ProfileOptions& options) {
+        static const std::size_t c_gamesPerThread[] = { 0, 2, 8, };
+
+        auto key = ResultCache::Machine();
+        for (const auto& v : c_tuningVariants)
+            key += std::string(", ") + v.m_version.m_label;
+        auto measured = false;
+        const auto variant = autotune(
+            AUTOMAGIC_TUNING_FILE,
+            key,
+            size_array(c_tuningVariants),
+            [&options] (std::size_t i) { return c_tuningVariants[i].m_turnCost(options.m_seed); },
+            options.m_retune,
+            measured
+        );
+        m_variant = &c_tuningVariants[variant];
+
+        const auto threads = options.m_threadCount;
+        auto widthMeasured = false;
+        const auto width = autotune(
+            AUTOMAGIC_TUNING_FILE,
+            key + ", " + m_variant->m_version.m_label + " threads " + std::to_string(threads),
+            size_array(c_gamesPerThread),
+            [this, &options, threads] (std::size_t i) {
+                auto o = options;
+                o.m_batchSize = c_gamesPerThread[i] * threads;
+                o.m_processCount = 1;
+                return m_variant->m_roundCost(o);
+            },
+            options.m_retune || measured,
+            widthMeasured
+        );
+        m_batchSize = c_gamesPerThread[width] * threads;
+        m_label = std::string(m_variant->m_version.m_label) + " tuned";
+
+        std::cout << "Tuned: " << m_variant->m_version.m_label << " Batch: " << m_batchSize;
+        std::cout << (measured || widthMeasured ? " (measured)" : " (saved)") << std::endl;
+        std::cout << std::endl;
+    }
+
+    ProfiledVersion Version () const {
+        return {&Profile, &Play, &Identify, &Verify, m_label.c_str(), false};
+    }
+
+    static void VerifySiblings (const char* label, const ProfileOptions& options) {
+        const auto& winner = Get().m_variant->m_version;
+        const auto family = GoldenOutputs::FamilyOf(label);
+        for (const auto& v : c_tuningVariants) {
+            if (&v.m_version != &winner && GoldenOutputs::FamilyOf(v.m_version.m_label) == family)
+                (void)v.m_version.m_verify(v.m_version.m_label, options);
+        }
+    }
+
+    static void Profile (const char* label, const ProfileOptions& options) {
+        const auto& tuned = Get();
+        if (options.m_verifySeeds > 0 && !options.m_coldStart)
+            VerifySiblings(label, options);
+        auto o = options;
+        if (o.m_batchSize == 0 && o.m_processCount <= 1)
+            o.m_batchSize = tuned.m_batchSize;
+        tuned.m_variant->m_version.m_profile(label, o);
+    }
+
+    static ProfileInfo Play (std::uint32_t seed, bool reuse) {
+        return Get().m_variant->m_version.m_play(seed, reuse);
+    }
+
+    static std::uint64_t Identify (const ProfileOptions& options) {
+        const auto& tuned = Get();
+        auto hash = tuned.m_variant->m_version.m_identify(options);
+        GameFingerprint::Hash(hash, tuned.m_batchSize);
+        return hash;
+    }
+
+    static std::string Verify (const char* label, const ProfileOptions& options) {
+        VerifySiblings(label, options);
+        return Get().m_variant->m_version.m_verify(label, options);
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+//  ProfileInterleaved plays the versions in rounds ordered by options.m_order, so that drift in
+//  clock speed, temperature or cache state is spread over every version instead of landing on
+//  whichever plays first or last. All versions play the same seed in a round, so rounds pair up:
+//  as well as each version's own summary it reports the mean per-round difference from the first
+//  version of its family (as GoldenOutputs groups them) with that difference's 95% confidence
+//  interval.
+//  Only plain single runs are played; batches, processes and the checks are sequential only.
+//--------------------------------------------------------------------------------------------------
+void ProfileInterleaved (
+    const ProfiledVersion* first,
+    const ProfiledVersion* last,
+    const ProfileOptions& options
+) {
+    static const char* const c_orders[] = { "sequential", "rotate", "random", "abba", };
+
+    const auto count = static_cast<std::size_t>(last - first);
+    std::vector<ProfileSummary> summaries(count);
+    std::vector<RunningStatistics> times(count);        // Nanoseconds
+    std::vector<RunningStatistics> differences(count);  // Nanoseconds, from the baseline
+    std::vector<double> roundTimes(count);
+    std::vector<std::size_t> baselines(count);
+    for (std::size_t v = 0; v < count; ++v) {
+        const auto family = GoldenOutputs::FamilyOf(first[v].m_label);
+        while (GoldenOutputs::FamilyOf(first[baselines[v]].m_label) != family)
+            ++baselines[v];
+    }
+    std::vector<std::size_t> order(count);
+    std::mt19937 engine{options.m_seed};
+
+    for (std::size_t round = 0; round < options.m_runCount; ++round) {
+        for (std::size_t i = 0; i < count; ++i) {
+            switch (options.m_order) {
+            case RunOrder::Rotate:
+                order[i] = (i + round) % count;
+                break;
+            case RunOrder::Abba:
+                order[i] = round % 2 == 0 ? i : count - 1 - i;
+                break;
+            default:
+                order[i] = i;
+                break;
+            }
+        }
+        if (options.m_order == RunOrder::Random)
+            std::shuffle(std::begin(order), std::end(order), engine);
+
+        for (auto v : order) {
+            const auto info = first[v].m_play(options.SeedFor(round), options.m_reuseGames);
+            summaries[v].Add(info);
+            roundTimes[v] = static_cast<double>((info.m_setup + info.m_play).count());
+            times[v].Add(roundTimes[v]);
+        }
+        for (std::size_t v = 0; v < count; ++v)
+            differences[v].Add(roundTimes[v] - roundTimes[baselines[v]]);
+    }
+
+    for (std::size_t v = 0; v < count; ++v) {
+        std::cout << first[v].m_label << std::endl;
+        std::cout << "Runs: " << summaries[v].m_count;
+        std::cout << " CI95: +/-" << 100.0 * relative_confidence_95(times[v]) << "%";
+        std::cout << " Order: " << c_orders[static_cast<int>(options.m_order)] << std::endl;
+        if (summaries[v].m_count > 0)
+            OutputSummary(summaries[v]);
+        std::cout << std::endl;
+    }
+
+    if (options.m_runCount < 2)
+        return;
+    for (std::size_t v = 0; v < count; ++v) {
+        if (baselines[v] == v)
+            continue;
+        const auto& d = differences[v];
+        const auto halfWidth = student_t_95(d.m_count - 1) * d.StandardError();
+        std::cout << "Paired " << first[v].m_label << " - " << first[baselines[v]].m_label;
+        std::cout << " Diff: " << d.Mean() / 1e6 << "ms";
+        std::cout << " (" << 100.0 * d.Mean() / times[baselines[v]].Mean() << "%)";
+        std::cout << " CI95: +/-" << halfWidth / 1e6 << "ms";
+        if (std::abs(d.Mean()) > halfWidth)
+            std::cout << " significant";
+        std::cout << std::endl;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+int main (int argc, char** argv) {
+    ProfileOptions options;
+    if (!ParseOptions(argc, argv, options))
+        return EXIT_FAILURE;
+    if (options.m_watchProcess != 0)
+        return WatchMetrics(options.m_watchProcess);
+    if (options.m_live) {
+        if (std::max(options.m_threadCount, options.m_processCount) > LiveMetrics::c_workerCount) {
+            std::cerr << "Error: --live shows at most " << LiveMetrics::c_workerCount;
+            std::cerr << " threads or processes" << std::endl;
+            return EXIT_FAILURE;
+        }
+        if (LivePublisher::Get().Open())
+            std::cerr << "Live: --watch=" << current_process_id() << std::endl;
+        else
+            std::cerr << "Warning: couldn't create the live metrics segment" << std::endl;
+    }
+
+    static const ProfiledVersion c_games[] = {
 #if 0
-        { &ProfileGame<Version0_0::Game>, "V0.0", },
-        { &ProfileGame<Version0_1::Game>, "V0.1", },
-        { &ProfileGame<Version0_2::Game>, "V0.2", },
-        { &ProfileGame<Version1_0::Game>, "V1.0", },
-        { &ProfileGame<Version1_1::Game>, "V1.1", },
-        { &ProfileGame<Version1_2::Game>, "V1.2", },
-        { &ProfileGame<Version2_0::Game>, "V2.0", },
-        { &ProfileGame<Version2_1::Game>, "V2.1", },
-        { &ProfileGame<Version2_2::Game>, "V2.2", },
-#endif
-        { &ProfileGame<Version3_0::Game>, "V3.0", },
-        { &ProfileGame<Version3_1::Game>, "V3.1", },
-        { &ProfileGame<Version3_2::Game>, "V3.2", },
+        ProfiledVersion::Of<Version0_0::Game<>>("V0.0"),
+        ProfiledVersion::Of<Version0_1::Game<>>("V0.1"),
+        ProfiledVersion::Of<Version0_2::Game<>>("V0.2"),
+        ProfiledVersion::Of<Version1_0::Game<>>("V1.0"),
+        ProfiledVersion::Of<Version1_1::Game<>>("V1.1"),
+        ProfiledVersion::Of<Version1_2::Game<>>("V1.2"),
+        ProfiledVersion::Of<Version2_0::Game<>>("V2.0"),
+        ProfiledVersion::Of<Version2_1::Game<>>("V2.1"),
+        ProfiledVersion::Of<Version2_2::Game<>>("V2.2"),
+#endif
+        ProfiledVersion::Of<Version3_0::Game<>>("V3.0"),
+        ProfiledVersion::Of<Version3_1::Game<>>("V3.1"),
+        ProfiledVersion::Of<Version3_2::Game<>>("V3.2"),
 #if 0
+        ProfiledVersion::Of<Version4_2::Game<>>("V4.2"),
+        ProfiledVersion::Of<Version3_0::Game<std::uint16_t>>("V3.0/16"),
+        ProfiledVersion::Of<Version3_1::Game<std::uint16_t>>("V3.1/16"),
+        ProfiledVersion::Of<Version3_2::Game<std::uint16_t>>("V3.2/16"),
 #endif
     };
+    const auto splitsTurns = std::any_of(
+        std::begin(c_games),
+        std::end(c_games),
+        [] (const auto& g) { return g.m_splitsTurns; }
+    );
+    if (options.m_gameThreads > 1 && !splitsTurns) {
+        std::cerr << "Warning: ignoring --game-threads, no enabled version splits its turns";
+        std::cerr << std::endl;
+        options.m_gameThreads = 1;
+    }
+
+    PrepareSystem(options);
+    ParallelFor::Get().Resize(options.m_gameThreads);
+    if (options.m_tune)
+        TunedVersion::Get().Tune(options);
+
+    std::vector<ProfiledVersion> versions(std::begin(c_games), std::end(c_games));
+    if (options.m_tune)
+        versions.push_back(TunedVersion::Get().Version());
+    if (options.m_order != RunOrder::Sequential) {
+        ProfileInterleaved(versions.data(), versions.data() + versions.size(), options);
+        return FailedChecks() > 0 ? EXIT_FAILURE : 0;
+    }
     call_with_range(
-        c_games, 
+        versions, 
         [] (auto&&... args) { return std::for_each(std::forward<decltype(args)>(args)...); }, 
-        [] (const auto& g) { g.m_function(g.m_label); }
+        [&options] (const auto& g) { ProfileCached(g, options); }
     );
 
-    return 0;
+    return FailedChecks() > 0 ? EXIT_FAILURE : 0;
 }
@@ -0,0 +1,168 @@
+//--------------------------------------------------------------------------------------------------
+//  Copyright 2016 Andy Bond
+// 
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//  
+//  http://www.apache.org/licenses/LICENSE-2.0
+//  
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//--------------------------------------------------------------------------------------------------
+#pragma once
+
+//--------------------------------------------------------------------------------------------------
+//  Allocation counters for checking that code which should not allocate doesn't. Every heap
+//  allocation in the process is counted: on glibc by wrapping malloc and friends (which catches
+//  operator new as well as C allocations), elsewhere by replacing the global operator new and
+//  delete. Take an AllocationCounters::Snapshot before and after the code in question and compare.
+//
+//  The hooks are global definitions, so exactly one translation unit must define
+//  AUTOMAGIC_ALLOCATION_HOOKS before including this header.
+//
+//  Everything compiles out unless AUTOMAGIC_ALLOCATION_STATS is defined to a non-zero value.
+//--------------------------------------------------------------------------------------------------
+#ifndef AUTOMAGIC_ALLOCATION_STATS
+#define AUTOMAGIC_ALLOCATION_STATS 0
+#endif
+
+#if AUTOMAGIC_ALLOCATION_STATS
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+//--------------------------------------------------------------------------------------------------
+//  The counters are constant initialized, so they work for allocations made before main and
+//  during other static initialization.
+//--------------------------------------------------------------------------------------------------
+struct AllocationCounters {
+    struct Snapshot {
+        std::uint64_t m_allocations;
+        std::uint64_t m_bytes;
+        std::uint64_t m_frees;
+
+        Snapshot operator- (const Snapshot& rhs) const {
+            return {m_allocations - rhs.m_allocations, m_bytes - rhs.m_bytes, m_frees - rhs.m_frees};
+        }
+    };
+
+    std::atomic<std::uint64_t> m_allocations;
+    std::atomic<std::uint64_t> m_bytes;
+    std::atomic<std::uint64_t> m_frees;
+
+    static AllocationCounters& Get () {
+        static AllocationCounters s_counters{};
+        return s_counters;
+    }
+
+    void OnAllocate (std::size_t bytes) {
+        m_allocations.fetch_add(1, std::memory_order_relaxed);
+        m_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    void OnFree (const void* p) {
+        if (p)
+            m_frees.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Snapshot Take () const {
+        return {
+            m_allocations.load(std::memory_order_relaxed),
+            m_bytes.load(std::memory_order_relaxed),
+            m_frees.load(std::memory_order_relaxed),
+        };
+    }
+};
+
+#if defined(AUTOMAGIC_ALLOCATION_HOOKS)
+#if defined(__GLIBC__)
+
+//--------------------------------------------------------------------------------------------------
+//  glibc exports its allocator under __libc_ names as well, so the wrappers can forward to it
+//  without dlsym (which itself allocates).
+//--------------------------------------------------------------------------------------------------
+extern "C" {
+
+void* __libc_malloc (std::size_t size);
+void* __libc_calloc (std::size_t count, std::size_t size);
+void* __libc_realloc (void* p, std::size_t size);
+void* __libc_memalign (std::size_t alignment, std::size_t size);
+void __libc_free (void* p);
+
+void* malloc (std::size_t size) {
+    AllocationCounters::Get().OnAllocate(size);
+    return __libc_malloc(size);
+}
+
+void* calloc (std::size_t count, std::size_t size) {
+    AllocationCounters::Get().OnAllocate(count * size);
+    return __libc_calloc(count, size);
+}
+
+//  realloc(p, 0) frees p and returns null, while a failed realloc returns null and keeps p
+void* realloc (void* p, std::size_t size) {
+    auto* const result = __libc_realloc(p, size);
+    if (result)
+        AllocationCounters::Get().OnAllocate(size);
+    if (result || size == 0)
+        AllocationCounters::Get().OnFree(p);
+    return result;
+}
+
+void* aligned_alloc (std::size_t alignment, std::size_t size) {
+    AllocationCounters::Get().OnAllocate(size);
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign (void** p, std::size_t alignment, std::size_t size) {
+    AllocationCounters::Get().OnAllocate(size);
+    *p = __libc_memalign(alignment, size);
+    return *p ? 0 : ENOMEM;
+}
+
+void free (void* p) {
+    AllocationCounters::Get().OnFree(p);
+    __libc_free(p);
+}
+
+} // extern "C"
+
+#else
+
+//--------------------------------------------------------------------------------------------------
+//  Elsewhere only C++ allocations are seen. The array, nothrow and sized forms all forward to
+//  these by default.
+//--------------------------------------------------------------------------------------------------
+void* operator new (std::size_t size) {
+    AllocationCounters::Get().OnAllocate(size);
+    if (auto* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new (std::size_t size, const std::nothrow_t&) noexcept {
+    AllocationCounters::Get().OnAllocate(size);
+    return std::malloc(size ? size : 1);
+}
+
+void operator delete (void* p) noexcept {
+    AllocationCounters::Get().OnFree(p);
+    std::free(p);
+}
+
+void operator delete (void* p, const std::nothrow_t&) noexcept {
+    AllocationCounters::Get().OnFree(p);
+    std::free(p);
+}
+
+#endif
+#endif // AUTOMAGIC_ALLOCATION_HOOKS
+
+#endif // AUTOMAGIC_ALLOCATION_STATS
@@ -0,0 +1,84 @@
+//--------------------------------------------------------------------------------------------------
+//  Copyright 2016 Andy Bond
+// 
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//  
+//  http://www.apache.org/licenses/LICENSE-2.0
+//  
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//--------------------------------------------------------------------------------------------------
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <string>
+
+#include "aux_process.h"
+
+//--------------------------------------------------------------------------------------------------
+//  autotune returns the index of the cheapest of 'count' candidates, where cost(i) measures
+//  candidate i (lower is better, e.g. nanoseconds per operation). The choice is saved in 'file'
+//  under 'key' and later calls with the same key reuse it without measuring, unless 'remeasure'.
+//  The key must therefore identify everything the choice depends on: the machine, the build and
+//  the list of candidates, since the choice is saved as an index into it.
+//  'measured' is set to whether the candidates were measured this time.
+//--------------------------------------------------------------------------------------------------
+template <typename F>
+std::size_t autotune (
+    const std::string& file,
+    const std::string& key,
+    std::size_t count,
+    F&& cost,
+    bool remeasure,
+    bool& measured
+) {
+    //  One "key<TAB>index" line per choice
+    std::map<std::string, std::size_t> choices;
+    {
+        std::ifstream in(file);
+        for (std::string line; std::getline(in, line); ) {
+            const auto tab = line.rfind('\t');
+            if (tab != std::string::npos)
+                choices[line.substr(0, tab)] = std::strtoull(line.c_str() + tab + 1, nullptr, 10);
+        }
+    }
+    const auto i = choices.find(key);
+    measured = remeasure || i == std::end(choices) || i->second >= count;
+    if (!measured)
+        return i->second;
+
+    std::size_t best = 0;
+    auto bestCost = std::numeric_limits<double>::infinity();
+    for (std::size_t candidate = 0; candidate < count; ++candidate) {
+        const double c = cost(candidate);
+        if (c < bestCost) {
+            best = candidate;
+            bestCost = c;
+        }
+    }
+    choices[key] = best;
+    //  Written aside and renamed into place, so concurrent runs never see a partial file
+    const auto temporary = file + "." + std::to_string(current_process_id());
+    {
+        std::ofstream out(temporary, std::ios::trunc);
+        for (const auto& choice : choices)
+            out << choice.first << '\t' << choice.second << '\n';
+        if (!out.flush()) {
+            (void)std::remove(temporary.c_str());
+            return best;
+        }
+    }
+    if (!replace_file(temporary, file))
+        (void)std::remove(temporary.c_str());
+    return best;
+}
@@ -15,9 +15,31 @@
 //--------------------------------------------------------------------------------------------------
 #pragma once
 
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
 #include <utility>
 
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define AUTOMAGIC_HAS_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define AUTOMAGIC_HAS_TSC 1
+#else
+#define AUTOMAGIC_HAS_TSC 0
+#endif
+
+//--------------------------------------------------------------------------------------------------
+//  ClockOverhead is the cost of one pair of Clock::now() calls, which timed_call subtracts from
+//  every duration it measures. It is zero unless a clock specialises it.
+//--------------------------------------------------------------------------------------------------
+template <typename Clock>
+struct ClockOverhead {
+    static typename Clock::duration Get () { return Clock::duration::zero(); }
+};
+
 //--------------------------------------------------------------------------------------------------
 template <
     typename Clock = std::chrono::steady_clock,
@@ -32,8 +54,145 @@ inline decltype(auto) timed_call (Duration& duration, F&& function, Ts&&... ts)
 
         explicit Timer (Duration& duration) : m_duration(duration), m_start(Clock::now()) { }
         ~Timer () {
-            m_duration = std::chrono::duration_cast<Duration>(Clock::now() - m_start);
+            const auto elapsed = Clock::now() - m_start;
+            const auto overhead = ClockOverhead<Clock>::Get();
+            m_duration = std::chrono::duration_cast<Duration>(
+                elapsed > overhead ? elapsed - overhead : Clock::duration::zero()
+            );
         }
     } timer(duration);
     return function(std::forward<Ts>(ts)...);
 }
+
+//--------------------------------------------------------------------------------------------------
+//  read_cycle_counter returns the processor's time stamp counter where there is one, otherwise the
+//  tick count of the steady clock. Either way, only differences between two reads are meaningful.
+//--------------------------------------------------------------------------------------------------
+inline std::uint64_t read_cycle_counter () noexcept {
+#if AUTOMAGIC_HAS_TSC
+    return __rdtsc();
+#else
+    return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+//  TscClock is a steady clock, usable as timed_call's Clock, which reads the invariant time stamp
+//  counter instead of asking the OS. Reads are fenced (lfence; rdtsc; lfence) so that work does not
+//  drift across them, and ticks are converted to nanoseconds with a rate calibrated against
+//  steady_clock on first use. Call TscClock::Get() before timing anything to keep that calibration
+//  (about 20ms) out of the measurements.
+//
+//  Without an invariant TSC (or on other architectures) it falls back to steady_clock, so it is
+//  always safe to use; m_invariant says which one it is reading.
+//--------------------------------------------------------------------------------------------------
+struct TscClock {
+    using rep = std::int64_t;
+    using period = std::nano;
+    using duration = std::chrono::duration<rep, period>;
+    using time_point = std::chrono::time_point<TscClock>;
+    static const bool is_steady = true;
+
+    bool m_invariant{};
+    double m_nanosecondsPerTick{1.0};
+    std::uint64_t m_base{};
+    duration m_overhead{};
+
+    static const TscClock& Get () {
+        static const TscClock s_clock;
+        return s_clock;
+    }
+
+    static time_point now () noexcept { return Get().Now(); }
+
+    // Ticks per second, or zero when falling back to steady_clock
+    double Frequency () const { return m_invariant ? 1e9 / m_nanosecondsPerTick : 0.0; }
+
+    static bool HasInvariantTsc () {
+#if AUTOMAGIC_HAS_TSC && defined(_MSC_VER)
+        int regs[4] = {};
+        __cpuid(regs, 0x80000000);
+        if (static_cast<unsigned>(regs[0]) < 0x80000007u)
+            return false;
+        __cpuid(regs, 0x80000007);
+        return (regs[3] & (1 << 8)) != 0;
+#elif AUTOMAGIC_HAS_TSC
+        unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+        if (__get_cpuid_max(0x80000000u, nullptr) < 0x80000007u)
+            return false;
+        __get_cpuid(0x80000007u, &eax, &ebx, &ecx, &edx);
+        return (edx & (1u << 8)) != 0;
+#else
+        return false;
+#endif
+    }
+
+    time_point Now () const noexcept {
+        if (!m_invariant)
+            return time_point(std::chrono::duration_cast<duration>(
+                std::chrono::steady_clock::now().time_since_epoch()
+            ));
+        const auto ticks = static_cast<double>(ReadFenced() - m_base);
+        return time_point(duration(static_cast<rep>(ticks * m_nanosecondsPerTick)));
+    }
+
+private:
+    TscClock () : m_invariant(HasInvariantTsc()) {
+        if (m_invariant)
+            Calibrate();
+        MeasureOverhead();
+    }
+
+    static std::uint64_t ReadFenced () noexcept {
+#if AUTOMAGIC_HAS_TSC
+        _mm_lfence();
+        const auto ticks = __rdtsc();
+        _mm_lfence();
+        return ticks;
+#else
+        return 0;
+#endif
+    }
+
+    // Counts ticks across a 20ms busy wait on steady_clock. Each steady_clock read is bracketed by
+    // two counter reads and matched with their midpoint, so the cost of the OS call cancels out.
+    void Calibrate () {
+        using Steady = std::chrono::steady_clock;
+        static const auto c_interval = std::chrono::milliseconds(20);
+
+        m_base = ReadFenced();
+        const auto midpoint = [] (std::uint64_t a, std::uint64_t b) { return a + (b - a) / 2; };
+        auto before = ReadFenced();
+        const auto start = Steady::now();
+        const auto startTicks = midpoint(before, ReadFenced());
+        auto end = start;
+        auto endTicks = startTicks;
+        do {
+            before = ReadFenced();
+            end = Steady::now();
+            endTicks = midpoint(before, ReadFenced());
+        } while (end - start < c_interval);
+        const auto ticks = static_cast<double>(endTicks - startTicks);
+        const auto ns = static_cast<double>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
+        );
+        m_nanosecondsPerTick = ns / ticks;
+    }
+
+    // The smallest gap between back to back reads is what a timed empty call costs.
+    void MeasureOverhead () {
+        static const auto c_samples = 1000;
+
+        auto best = duration::max();
+        for (auto i = 0; i < c_samples; ++i) {
+            const auto start = Now();
+            best = std::min(best, Now() - start);
+        }
+        m_overhead = best;
+    }
+};
+
+template <>
+struct ClockOverhead<TscClock> {
+    static TscClock::duration Get () { return TscClock::Get().m_overhead; }
+};
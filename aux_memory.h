@@ -0,0 +1,204 @@
+//--------------------------------------------------------------------------------------------------
+//  Copyright 2016 Andy Bond
+// 
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//  
+//  http://www.apache.org/licenses/LICENSE-2.0
+//  
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//--------------------------------------------------------------------------------------------------
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+//--------------------------------------------------------------------------------------------------
+//  PageMode selects how PageArena backs its memory.
+//  Transparent asks the kernel to use huge pages where it can (Linux THP); Explicit maps them
+//  directly (MAP_HUGETLB / MEM_LARGE_PAGES), which needs pages reserved by the administrator and
+//  falls back to Transparent when none are available.
+//--------------------------------------------------------------------------------------------------
+enum class PageMode {
+    Default,
+    Transparent,
+    Explicit,
+};
+
+//--------------------------------------------------------------------------------------------------
+//  PageArena is a bump allocator over one block of virtual memory obtained straight from the
+//  operating system. Nothing is touched on allocation, so each page is physically placed on the
+//  NUMA node of the first thread to write it; handing every worker its own page aligned slice
+//  therefore keeps that worker's state local without any NUMA API.
+//--------------------------------------------------------------------------------------------------
+struct PageArena {
+    static constexpr std::size_t c_hugePageSize = std::size_t{2} << 20;
+
+    unsigned char* m_data{};
+    std::size_t m_capacity{};
+    std::size_t m_used{};
+    std::size_t m_pageSize{};
+    PageMode m_mode{PageMode::Default};
+
+    PageArena () = default;
+    PageArena (std::size_t capacity, PageMode mode) {
+        Map(capacity, mode);
+    }
+    PageArena (const PageArena&) = delete;
+    PageArena& operator= (const PageArena&) = delete;
+    ~PageArena () {
+        Unmap();
+    }
+
+    static std::size_t RoundUp (std::size_t size, std::size_t alignment) {
+        return (size + alignment - 1) / alignment * alignment;
+    }
+
+    static std::size_t SystemPageSize () {
+#if defined(_WIN32)
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return info.dwPageSize;
+#else
+        return static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#endif
+    }
+
+    bool Map (std::size_t capacity, PageMode mode) {
+        Unmap();
+        if (mode == PageMode::Explicit && MapPages(capacity, c_hugePageSize, true))
+            m_mode = PageMode::Explicit;
+        else if (mode != PageMode::Default && MapPages(capacity, c_hugePageSize, false))
+            m_mode = PageMode::Transparent;
+        else if (MapPages(capacity, SystemPageSize(), false))
+            m_mode = PageMode::Default;
+        return m_data != nullptr;
+    }
+
+    void Unmap () {
+        if (m_data != nullptr) {
+#if defined(_WIN32)
+            VirtualFree(m_data, 0, MEM_RELEASE);
+#else
+            munmap(m_data, m_capacity);
+#endif
+        }
+        m_data = nullptr;
+        m_capacity = m_used = 0;
+    }
+
+    void* Allocate (std::size_t size, std::size_t alignment) {
+        const auto offset = RoundUp(m_used, alignment);
+        if (m_data == nullptr || offset + size > m_capacity)
+            throw std::bad_alloc();
+        m_used = offset + size;
+        return m_data + offset;
+    }
+
+    void Reset () {
+        m_used = 0;
+    }
+
+    bool MapPages (std::size_t capacity, std::size_t pageSize, bool explicitHugePages) {
+#if defined(_WIN32)
+        //  Windows has no transparent huge pages; only large page allocations qualify.
+        if (explicitHugePages)
+            pageSize = GetLargePageMinimum();
+        else if (pageSize != SystemPageSize())
+            return false;
+        if (pageSize == 0)
+            return false;
+        const auto size = RoundUp(capacity, pageSize);
+        const DWORD type = MEM_RESERVE | MEM_COMMIT | (explicitHugePages ? MEM_LARGE_PAGES : 0);
+        auto* data = VirtualAlloc(nullptr, size, type, PAGE_READWRITE);
+        if (data == nullptr)
+            return false;
+        m_capacity = size;
+#else
+        const auto size = RoundUp(capacity, pageSize);
+        auto flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#if defined(MAP_HUGETLB)
+        if (explicitHugePages)
+            flags |= MAP_HUGETLB;
+#else
+        if (explicitHugePages)
+            return false;
+#endif
+        //  Over-map by a page so the block can be aligned to huge page boundaries for THP.
+        const auto extra = (pageSize != SystemPageSize() && !explicitHugePages) ? pageSize : 0;
+        auto* mapped = mmap(nullptr, size + extra, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if (mapped == MAP_FAILED)
+            return false;
+        auto* data = static_cast<unsigned char*>(mapped);
+        if (extra != 0) {
+            const auto address = reinterpret_cast<std::uintptr_t>(mapped);
+            const auto aligned = RoundUp(address, pageSize);
+            if (aligned != address)
+                munmap(mapped, aligned - address);
+            if (extra != aligned - address)
+                munmap(reinterpret_cast<void*>(aligned + size), extra - (aligned - address));
+            data = reinterpret_cast<unsigned char*>(aligned);
+#if defined(MADV_HUGEPAGE)
+            if (madvise(data, size, MADV_HUGEPAGE) != 0) {
+                munmap(data, size);
+                return false;
+            }
+#else
+            munmap(data, size);
+            return false;
+#endif
+        }
+        m_capacity = size;
+#endif
+        m_data = static_cast<unsigned char*>(data);
+        m_used = 0;
+        m_pageSize = pageSize;
+        return true;
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+//  ArenaAllocator lets standard containers draw from a PageArena. Deallocation is a no-op; the
+//  memory is reclaimed all at once by PageArena::Reset or the arena's destruction.
+//--------------------------------------------------------------------------------------------------
+template <typename T>
+struct ArenaAllocator {
+    using value_type = T;
+
+    PageArena* m_arena;
+
+    explicit ArenaAllocator (PageArena& arena) noexcept : m_arena(&arena) { }
+    template <typename U>
+    ArenaAllocator (const ArenaAllocator<U>& rhs) noexcept : m_arena(rhs.m_arena) { }
+
+    T* allocate (std::size_t n) {
+        return static_cast<T*>(m_arena->Allocate(n * sizeof(T), alignof(T)));
+    }
+    void deallocate (T*, std::size_t) noexcept { }
+};
+
+template <typename T, typename U>
+bool operator== (const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) noexcept {
+    return lhs.m_arena == rhs.m_arena;
+}
+
+template <typename T, typename U>
+bool operator!= (const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) noexcept {
+    return !(lhs == rhs);
+}
@@ -15,6 +15,12 @@
 //--------------------------------------------------------------------------------------------------
 #pragma once
 
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
 //--------------------------------------------------------------------------------------------------
 //  In lieu of std::transform_reduce and std::accumulate which specifies that the range must not
 //  be modified.
@@ -37,10 +43,39 @@ T accumutate (InputIt first, InputIt last, UnaryOp&& unaryOp, BinaryOp&& binaryO
 //--------------------------------------------------------------------------------------------------
 template <typename A, typename B, typename C = std::common_type_t<A, B>>
 auto modulo (A&& a, B&& b) -> std::enable_if_t<std::is_floating_point<C>::value, C> {
-    return std::remainder(a, b);
+    return std::fmod(a, b);
 }
 
 template <typename A, typename B, typename C = std::common_type_t<A, B>>
 auto modulo (A&& a, B&& b) -> std::enable_if_t<std::is_integral<C>::value, C> {
     return a % b;
 }
+
+//--------------------------------------------------------------------------------------------------
+//  capped_max is the largest value of T, or of Cap for an integral T wider than Cap. The games use
+//  it for c_lifeMax so that 64 bit lives play within unsigned int's range, exactly as 32 bit lives
+//  do, where with their full range a game would practically never end. Floating point types keep
+//  their own maximum: their damage is continuous, so a life seldom falls to exactly 0 and their
+//  games practically never end whatever the maximum. They are instantiated only to check that the
+//  games compile with them.
+//--------------------------------------------------------------------------------------------------
+template <typename T, typename Cap>
+constexpr T capped_max () {
+    return std::is_integral<T>::value &&
+        static_cast<std::uintmax_t>(std::numeric_limits<T>::max()) >
+        static_cast<std::uintmax_t>(std::numeric_limits<Cap>::max()) ?
+            static_cast<T>(std::numeric_limits<Cap>::max()) :
+            std::numeric_limits<T>::max();
+}
+
+//--------------------------------------------------------------------------------------------------
+//  saturating_add adds a non-negative 'b' to 'a', clamping at the largest value of A rather than
+//  wrapping (integers) or rounding past it (floating point). 'b' may be of a wider type, such as
+//  the int a narrow integer is promoted to.
+//--------------------------------------------------------------------------------------------------
+template <typename A, typename B, typename C = std::common_type_t<A, B>>
+A saturating_add (const A& a, const B& b) {
+    const auto maximum = std::numeric_limits<A>::max();
+    const auto headroom = static_cast<C>(maximum) - static_cast<C>(a);
+    return static_cast<C>(b) < headroom ? static_cast<A>(a + b) : maximum;
+}
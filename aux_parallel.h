@@ -0,0 +1,161 @@
+//--------------------------------------------------------------------------------------------------
+//  Copyright 2016 Andy Bond
+// 
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//  
+//  http://www.apache.org/licenses/LICENSE-2.0
+//  
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//--------------------------------------------------------------------------------------------------
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <pthread.h>
+#endif
+
+//--------------------------------------------------------------------------------------------------
+//  ParallelFor splits [0, count) into chunks of c_chunkSize and hands them out to a fixed set of
+//  worker threads and the calling thread, returning once every chunk is done. It is meant to be
+//  called once per step of a simulation, so the workers stay alive between calls and wait for
+//  the next one; nothing is allocated per call. With no workers (the default) Run simply calls
+//  the function on the whole range.
+//
+//  Which thread processes a chunk varies from call to call, so functions must not depend on it:
+//  each chunk should only touch state of its own.
+//
+//  The pool belongs to one process. A forked child has a copy of the pool but none of its threads
+//  (and perhaps a copy of a mutex one of them held), so Get hands the child a new pool of the same
+//  size instead and the copy is abandoned.
+//--------------------------------------------------------------------------------------------------
+struct ParallelFor {
+    static const std::size_t c_chunkSize = 1024;
+
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_idle;
+    std::size_t m_generation{};
+    std::size_t m_busy{};
+    bool m_stop{};
+
+    // The current call, valid while m_busy > 0
+    void (*m_invoke)(const void*, std::size_t, std::size_t){};
+    const void* m_function{};
+    std::size_t m_count{};
+    std::atomic<std::size_t> m_next{};
+
+    static ParallelFor& Get () {
+        return *Current();
+    }
+
+    ParallelFor () = default;
+    ParallelFor (const ParallelFor&) = delete;
+    ParallelFor& operator= (const ParallelFor&) = delete;
+    ~ParallelFor () { Resize(1); }
+
+    std::size_t ThreadCount () const { return m_workers.size() + 1; }
+
+    // Not to be called while Run is in progress
+    void Resize (std::size_t threads) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (auto& w : m_workers)
+            w.join();
+        m_workers.clear();
+        std::size_t generation;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = false;
+            generation = m_generation;
+        }
+        // New workers start from the current generation rather than rerun the last call
+        for (std::size_t i = 1; i < threads; ++i)
+            m_workers.emplace_back([this, generation] { Work(generation); });
+    }
+
+    template <typename F>   // void (std::size_t first, std::size_t last)
+    void Run (std::size_t count, const F& function) {
+        if (m_workers.empty() || count <= c_chunkSize) {
+            function(std::size_t{0}, count);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_invoke = [] (const void* f, std::size_t first, std::size_t last) {
+                (*static_cast<const F*>(f))(first, last);
+            };
+            m_function = &function;
+            m_count = count;
+            m_next.store(0, std::memory_order_relaxed);
+            m_busy = m_workers.size() + 1;
+            ++m_generation;
+        }
+        m_wake.notify_all();
+        Chunks();
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (--m_busy > 0)
+            m_idle.wait(lock, [this] { return m_busy == 0; });
+    }
+
+private:
+    static ParallelFor*& Current () {
+        static ParallelFor* s_current = Start();
+        return s_current;
+    }
+
+    static ParallelFor* Start () {
+#if !defined(_WIN32)
+        pthread_atfork(nullptr, nullptr, [] {
+            auto& current = Current();
+            const auto threads = current->ThreadCount();
+            current = new ParallelFor;      // Never destroyed; children leave with _exit
+            current->Resize(threads);
+        });
+#endif
+        static ParallelFor s_parallel;
+        return &s_parallel;
+    }
+
+    void Chunks () {
+        for (;;) {
+            const auto first = m_next.fetch_add(c_chunkSize, std::memory_order_relaxed);
+            if (first >= m_count)
+                return;
+            m_invoke(m_function, first, std::min(first + c_chunkSize, m_count));
+        }
+    }
+
+    void Work (std::size_t seen) {
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [&] { return m_stop || m_generation != seen; });
+                if (m_stop)
+                    return;
+                seen = m_generation;
+            }
+            Chunks();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_busy == 0)
+                m_idle.notify_one();
+        }
+    }
+};
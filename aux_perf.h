@@ -0,0 +1,128 @@
+//--------------------------------------------------------------------------------------------------
+//  Copyright 2016 Andy Bond
+// 
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//  
+//  http://www.apache.org/licenses/LICENSE-2.0
+//  
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//--------------------------------------------------------------------------------------------------
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+//--------------------------------------------------------------------------------------------------
+//  PerfCounters counts memory system events for the calling thread and any thread it starts while
+//  the counters are open, using Linux perf events. Counters the kernel refuses (unsupported PMU,
+//  perf_event_paranoid, other platforms) simply report as unavailable.
+//--------------------------------------------------------------------------------------------------
+struct PerfCounters {
+    enum Event {
+        DtlbLoadMisses,     // Data TLB misses on loads
+        ItlbLoadMisses,     // Instruction TLB misses
+        NodeLoads,          // Loads which missed the LLC and were served by some NUMA node
+        NodeLoadMisses,     // ... of those, the loads served by a remote node
+        PageFaults,
+        EventCount,
+    };
+
+    using Values = std::array<std::uint64_t, EventCount>;
+
+    std::array<int, EventCount> m_fds;
+
+    PerfCounters () {
+        m_fds.fill(-1);
+    }
+    PerfCounters (const PerfCounters&) = delete;
+    PerfCounters& operator= (const PerfCounters&) = delete;
+    ~PerfCounters () {
+        Close();
+    }
+
+    static const char* Name (Event e) {
+        static const char* const c_names[EventCount] = {
+            "dTLB-misses", "iTLB-misses", "node-loads", "node-remote", "page-faults",
+        };
+        return c_names[e];
+    }
+
+    bool Available (Event e) const { return m_fds[e] >= 0; }
+
+#if defined(__linux__)
+    static int Open (std::uint32_t type, std::uint64_t config) {
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    static std::uint64_t Cache (std::uint64_t cache, std::uint64_t result) {
+        return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (result << 16);
+    }
+
+    void Start () {
+        Close();
+        m_fds[DtlbLoadMisses] = Open(
+            PERF_TYPE_HW_CACHE, Cache(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_RESULT_MISS)
+        );
+        m_fds[ItlbLoadMisses] = Open(
+            PERF_TYPE_HW_CACHE, Cache(PERF_COUNT_HW_CACHE_ITLB, PERF_COUNT_HW_CACHE_RESULT_MISS)
+        );
+        m_fds[NodeLoads] = Open(
+            PERF_TYPE_HW_CACHE, Cache(PERF_COUNT_HW_CACHE_NODE, PERF_COUNT_HW_CACHE_RESULT_ACCESS)
+        );
+        m_fds[NodeLoadMisses] = Open(
+            PERF_TYPE_HW_CACHE, Cache(PERF_COUNT_HW_CACHE_NODE, PERF_COUNT_HW_CACHE_RESULT_MISS)
+        );
+        m_fds[PageFaults] = Open(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS);
+        for (auto fd : m_fds) {
+            if (fd >= 0)
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    //  Inherited counts include threads which have exited, so join workers before stopping.
+    Values Stop () {
+        Values values{};
+        for (std::size_t i = 0; i < m_fds.size(); ++i) {
+            if (m_fds[i] < 0)
+                continue;
+            ioctl(m_fds[i], PERF_EVENT_IOC_DISABLE, 0);
+            if (read(m_fds[i], &values[i], sizeof(values[i])) != sizeof(values[i]))
+                values[i] = 0;
+        }
+        return values;
+    }
+
+    void Close () {
+        for (auto& fd : m_fds) {
+            if (fd >= 0)
+                close(fd);
+            fd = -1;
+        }
+    }
+#else
+    void Start () { }
+    Values Stop () { return Values{}; }
+    void Close () { }
+#endif
+};
@@ -0,0 +1,337 @@
+//--------------------------------------------------------------------------------------------------
+//  Copyright 2016 Andy Bond
+// 
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//  
+//  http://www.apache.org/licenses/LICENSE-2.0
+//  
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//--------------------------------------------------------------------------------------------------
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+//--------------------------------------------------------------------------------------------------
+//  SharedMemory is an anonymous mapping which child processes forked after its creation share
+//  with their parent, so workers can write results straight into the coordinator's memory.
+//  It starts zeroed. (Without fork it is ordinary memory, which keeps the in-process fallback of
+//  fork_shards working.)
+//--------------------------------------------------------------------------------------------------
+struct SharedMemory {
+    void* m_data{};
+    std::size_t m_size{};
+
+    explicit SharedMemory (std::size_t size) : m_size(size) {
+#if defined(_WIN32)
+        m_data = ::operator new(size);
+        std::fill_n(static_cast<unsigned char*>(m_data), size, 0);
+#else
+        m_data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (m_data == MAP_FAILED)
+            throw std::bad_alloc();
+#endif
+    }
+    SharedMemory (const SharedMemory&) = delete;
+    SharedMemory& operator= (const SharedMemory&) = delete;
+    ~SharedMemory () {
+#if defined(_WIN32)
+        ::operator delete(m_data);
+#else
+        munmap(m_data, m_size);
+#endif
+    }
+
+    template <typename T>
+    T* As (std::size_t byteOffset = 0) const {
+        return reinterpret_cast<T*>(static_cast<unsigned char*>(m_data) + byteOffset);
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+//  fork_shards runs shard(i) for every i in [0, count) in a child process of its own, all of them
+//  concurrently. A shard whose process crashes, is killed or returns false is started again in a
+//  new process, up to 'retries' more times. Returns the shards which never succeeded.
+//
+//  The children leave with _exit: they never flush the parent's stdio buffers a second time or
+//  run its static destructors. Where there is no fork the shards simply run in this process.
+//--------------------------------------------------------------------------------------------------
+template <typename F>
+std::vector<std::size_t> fork_shards (std::size_t count, std::size_t retries, F&& shard) {
+    std::vector<std::size_t> pending;
+    for (std::size_t i = 0; i < count; ++i)
+        pending.push_back(i);
+
+#if defined(_WIN32)
+    (void)retries;
+    std::vector<std::size_t> failed;
+    for (auto i : pending) {
+        if (!shard(i))
+            failed.push_back(i);
+    }
+    return failed;
+#else
+    for (std::size_t attempt = 0; attempt <= retries && !pending.empty(); ++attempt) {
+        std::fflush(nullptr);
+
+        std::vector<std::pair<pid_t, std::size_t>> children;
+        std::vector<std::size_t> failed;
+        for (auto i : pending) {
+            const auto pid = fork();
+            if (pid == 0) {
+                auto ok = false;
+                try {
+                    ok = shard(i);
+                }
+                catch (...) {
+                }
+                std::fflush(nullptr);
+                _exit(ok ? 0 : 1);
+            }
+            if (pid < 0)
+                failed.push_back(i);
+            else
+                children.emplace_back(pid, i);
+        }
+        for (const auto& child : children) {
+            int status = 0;
+            if (waitpid(child.first, &status, 0) != child.first ||
+                !WIFEXITED(status) ||
+                WEXITSTATUS(status) != 0)
+            {
+                failed.push_back(child.second);
+            }
+        }
+        pending.swap(failed);
+    }
+    return pending;
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+//  current_process_id returns this process's id, as other processes (and --watch) know it.
+//--------------------------------------------------------------------------------------------------
+inline std::uint64_t current_process_id () {
+#if defined(_WIN32)
+    return GetCurrentProcessId();
+#else
+    return static_cast<std::uint64_t>(getpid());
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+//  process_alive returns whether process 'id' is still running.
+//--------------------------------------------------------------------------------------------------
+inline bool process_alive (std::uint64_t id) {
+#if defined(_WIN32)
+    const auto process = OpenProcess(SYNCHRONIZE, FALSE, static_cast<DWORD>(id));
+    if (!process)
+        return false;
+    const auto running = WaitForSingleObject(process, 0) == WAIT_TIMEOUT;
+    CloseHandle(process);
+    return running;
+#else
+    return kill(static_cast<pid_t>(id), 0) == 0 || errno == EPERM;
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+//  replace_file renames 'from' over 'to' in one step, so that another process reading 'to' sees
+//  either the old file or the new one and never a partly written one.
+//--------------------------------------------------------------------------------------------------
+inline bool replace_file (const std::string& from, const std::string& to) {
+#if defined(_WIN32)
+    return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+//  NamedSharedMemory is a mapping which unrelated processes attach to by name ("/name"). Create
+//  makes a new zeroed segment, which is removed again when its creator is destroyed; Read attaches
+//  to an existing one, read only. m_data is null if that failed.
+//  POSIX segments outlive a creator which dies without being destroyed, so Create replaces one
+//  already under the name (names should be unique to their creator, e.g. carry its process id) and
+//  Remove lets another process clean up after a creator it knows has died. Windows removes a
+//  mapping with its last handle, so there Remove does nothing.
+//--------------------------------------------------------------------------------------------------
+struct NamedSharedMemory {
+    enum class Access {
+        Create,
+        Read,
+    };
+
+    std::string m_name;
+    void* m_data{};
+    std::size_t m_size{};
+    bool m_owner{};
+#if defined(_WIN32)
+    HANDLE m_mapping{};
+#endif
+
+    NamedSharedMemory (const std::string& name, std::size_t size, Access access) :
+        m_name(name),
+        m_size(size)
+    {
+#if defined(_WIN32)
+        const auto mappingName = "Local\\" + name.substr(name.find_first_not_of('/'));
+        if (access == Access::Create) {
+            m_mapping = CreateFileMappingA(
+                INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                static_cast<DWORD>(static_cast<std::uint64_t>(size) >> 32),
+                static_cast<DWORD>(size),
+                mappingName.c_str()
+            );
+            if (m_mapping && GetLastError() == ERROR_ALREADY_EXISTS) {
+                CloseHandle(m_mapping);
+                m_mapping = nullptr;
+            }
+        }
+        else {
+            m_mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, mappingName.c_str());
+        }
+        if (!m_mapping)
+            return;
+        const auto rights = access == Access::Create ? FILE_MAP_WRITE : FILE_MAP_READ;
+        m_data = MapViewOfFile(m_mapping, rights, 0, 0, size);
+        m_owner = m_data && access == Access::Create;
+#else
+        const auto create = access == Access::Create;
+        const auto& open = [&name, create] {
+            return create ?
+                shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR) :
+                shm_open(name.c_str(), O_RDONLY, 0);
+        };
+        auto fd = open();
+        if (fd < 0 && create && errno == EEXIST && Remove(name))
+            fd = open();
+        if (fd < 0)
+            return;
+        struct stat status;
+        const auto sized = create ?
+            ftruncate(fd, static_cast<off_t>(size)) == 0 :
+            fstat(fd, &status) == 0 && static_cast<std::size_t>(status.st_size) >= size;
+        if (sized) {
+            const auto protection = create ? PROT_READ | PROT_WRITE : PROT_READ;
+            m_data = mmap(nullptr, size, protection, MAP_SHARED, fd, 0);
+            if (m_data == MAP_FAILED)
+                m_data = nullptr;
+        }
+        close(fd);
+        if (create && !m_data)
+            shm_unlink(name.c_str());
+        m_owner = m_data && create;
+#endif
+    }
+    NamedSharedMemory (const NamedSharedMemory&) = delete;
+    NamedSharedMemory& operator= (const NamedSharedMemory&) = delete;
+    ~NamedSharedMemory () {
+#if defined(_WIN32)
+        if (m_data)
+            UnmapViewOfFile(m_data);
+        if (m_mapping)
+            CloseHandle(m_mapping);
+#else
+        if (m_data)
+            munmap(m_data, m_size);
+        if (m_owner)
+            shm_unlink(m_name.c_str());
+#endif
+    }
+
+    static bool Remove (const std::string& name) {
+#if defined(_WIN32)
+        (void)name;
+        return true;
+#else
+        return shm_unlink(name.c_str()) == 0;
+#endif
+    }
+
+    template <typename T>
+    T* As (std::size_t byteOffset = 0) const {
+        return reinterpret_cast<T*>(static_cast<unsigned char*>(m_data) + byteOffset);
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+//  Seqlocked holds a T which a single writer updates without ever waiting, and which readers in
+//  this or other processes copy without locks: a reader retries if the sequence number shows a
+//  write overlapped its copy. T is copied as lock free atomic words, so a torn read is never a
+//  data race and the words stay valid in memory shared between processes.
+//--------------------------------------------------------------------------------------------------
+template <typename T>
+struct Seqlocked {
+    static_assert(std::is_trivially_copyable<T>::value, "Copied word by word");
+    static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "Shared between processes");
+    static const std::size_t c_wordCount =
+        (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+    std::atomic<std::uint64_t> m_sequence{};    // Odd while a write is in progress
+    std::atomic<std::uint64_t> m_words[c_wordCount];
+
+    Seqlocked () {
+        for (auto& w : m_words)
+            w.store(0, std::memory_order_relaxed);
+    }
+
+    void Store (const T& value) {
+        std::uint64_t words[c_wordCount] = {};
+        std::memcpy(words, &value, sizeof(T));
+        const auto sequence = m_sequence.load(std::memory_order_relaxed);
+        m_sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t i = 0; i < c_wordCount; ++i)
+            m_words[i].store(words[i], std::memory_order_relaxed);
+        m_sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    // False if a write overlapped every one of 'attempts' copies
+    bool Load (T& value, std::size_t attempts = 64) const {
+        for (; attempts > 0; --attempts) {
+            const auto before = m_sequence.load(std::memory_order_acquire);
+            if (before & 1)
+                continue;
+            std::uint64_t words[c_wordCount];
+            for (std::size_t i = 0; i < c_wordCount; ++i)
+                words[i] = m_words[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (m_sequence.load(std::memory_order_relaxed) == before) {
+                std::memcpy(&value, words, sizeof(T));
+                return true;
+            }
+        }
+        return false;
+    }
+};
@@ -15,6 +15,13 @@
 //--------------------------------------------------------------------------------------------------
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <numeric>
 #include <random>
 #include <type_traits>
 
@@ -27,13 +34,14 @@ template <
     typename A, 
     typename B,
     typename C = typename std::common_type<A, B>::type,
-    typename D = std::uniform_int_distribution<C>
+    typename P = decltype(+std::declval<C>()), // char sized types are not valid IntTypes
+    typename D = std::uniform_int_distribution<P>
 >
 auto make_uniform_distribution (
     const A& minimum, 
     const B& maximum
 ) -> typename std::enable_if<std::is_integral<C>::value, D>::type {
-    return D{static_cast<C>(minimum), static_cast<C>(maximum)};
+    return D{static_cast<P>(minimum), static_cast<P>(maximum)};
 }
 
 template <
@@ -49,6 +57,77 @@ auto make_uniform_distribution (
     return D{static_cast<C>(minimum), static_cast<C>(maximum)};
 }
 
+//--------------------------------------------------------------------------------------------------
+//  uniform_distribution_t names the distribution make_uniform_distribution selects for T, for code
+//  which spells out its types.
+//--------------------------------------------------------------------------------------------------
+template <typename T>
+using uniform_distribution_t = decltype(
+    make_uniform_distribution(std::declval<T>(), std::declval<T>())
+);
+
+//--------------------------------------------------------------------------------------------------
+//  FixedUniformDistribution is make_uniform_distribution(Minimum, Maximum) for bounds known at
+//  compile time, and draws exactly the same values. When the bounds span the generator's whole
+//  range (e.g. [0, c_lifeMax] for 32 bit lives from std::mt19937) a draw is the generator's next
+//  value offset by Minimum, with none of the distribution's range checks left to run; otherwise
+//  it draws through the standard distribution.
+//--------------------------------------------------------------------------------------------------
+template <typename T, T Minimum, T Maximum>
+struct FixedUniformDistribution {
+    static_assert(std::is_integral<T>::value, "FixedUniformDistribution requires an integral type");
+    static_assert(Minimum <= Maximum, "FixedUniformDistribution requires Minimum <= Maximum");
+
+    using result_type = T;
+
+    template <typename G>
+    using IsFullRange = std::integral_constant<bool,
+        static_cast<std::uintmax_t>(Maximum) - static_cast<std::uintmax_t>(Minimum) ==
+        static_cast<std::uintmax_t>(G::max() - G::min())
+    >;
+
+    static constexpr result_type min () { return Minimum; }
+    static constexpr result_type max () { return Maximum; }
+
+    template <typename UniformRandomBitGenerator>
+    result_type operator() (UniformRandomBitGenerator& g) const {
+        return Draw(g, IsFullRange<UniformRandomBitGenerator>{});
+    }
+
+private:
+    template <typename G>
+    static result_type Draw (G& g, std::true_type) {
+        return static_cast<T>(static_cast<std::uintmax_t>(Minimum) + (g() - G::min()));
+    }
+
+    template <typename G>
+    static result_type Draw (G& g, std::false_type) {
+        return static_cast<T>(make_uniform_distribution(Minimum, Maximum)(g));
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+//  BoundedUniformDistribution draws from [Bounds::min(), Bounds::max()], where Bounds has constexpr
+//  static min and max as std::numeric_limits does. Only integers can be template arguments, so an
+//  integral T gets a FixedUniformDistribution and any other T the distribution
+//  make_uniform_distribution selects for the same bounds.
+//--------------------------------------------------------------------------------------------------
+template <typename T, typename Bounds, bool = std::is_integral<T>::value>
+struct BoundedUniformDistribution : FixedUniformDistribution<T, Bounds::min(), Bounds::max()> { };
+
+template <typename T, typename Bounds>
+struct BoundedUniformDistribution<T, Bounds, false> {
+    using result_type = T;
+
+    static constexpr result_type min () { return Bounds::min(); }
+    static constexpr result_type max () { return Bounds::max(); }
+
+    template <typename UniformRandomBitGenerator>
+    result_type operator() (UniformRandomBitGenerator& g) const {
+        return static_cast<T>(make_uniform_distribution(min(), max())(g));
+    }
+};
+
 //--------------------------------------------------------------------------------------------------
 //  In lieu of C++17 std::sample, this is also just intended to select one random element from the
 //  range.
@@ -58,3 +137,200 @@ auto random_element (InputIt first, InputIt last, UniformRandomBitGenerator&& g)
     auto&& dis = make_uniform_distribution(0, std::distance(first, last) - 1);
     return std::next(first, dis(g));
 }
+
+//--------------------------------------------------------------------------------------------------
+//  AliasTable is the weighted counterpart of random_element: built once from N weights with Vose's
+//  alias method, it then selects an index in O(1) from a single 32 bit draw. The high half of
+//  draw * N picks the column and the low half is the coin that decides between the column and
+//  its alias.
+//--------------------------------------------------------------------------------------------------
+template <std::size_t N>
+struct AliasTable {
+    static_assert(N > 0, "AliasTable requires at least one weight");
+
+    static constexpr std::uint64_t c_one = std::uint64_t{1} << 32;
+
+    std::array<std::uint64_t, N> m_threshold{};
+    std::array<std::size_t, N> m_alias{};
+
+    explicit AliasTable (const std::array<double, N>& weights) {
+        const auto total = std::accumulate(std::begin(weights), std::end(weights), 0.0);
+        std::array<double, N> scaled{};
+        std::array<std::size_t, N> small{};
+        std::array<std::size_t, N> large{};
+        std::size_t smallCount = 0;
+        std::size_t largeCount = 0;
+        for (std::size_t i = 0; i < N; ++i) {
+            scaled[i] = total > 0.0 ? weights[i] * N / total : 1.0;
+            (scaled[i] < 1.0 ? small[smallCount++] : large[largeCount++]) = i;
+        }
+        while (smallCount > 0 && largeCount > 0) {
+            const auto s = small[--smallCount];
+            const auto l = large[--largeCount];
+            m_threshold[s] = static_cast<std::uint64_t>(scaled[s] * c_one);
+            m_alias[s] = l;
+            scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+            (scaled[l] < 1.0 ? small[smallCount++] : large[largeCount++]) = l;
+        }
+        //  Whatever remains is 1 up to rounding error and always keeps its own column.
+        while (largeCount > 0) {
+            const auto l = large[--largeCount];
+            m_threshold[l] = c_one;
+            m_alias[l] = l;
+        }
+        while (smallCount > 0) {
+            const auto s = small[--smallCount];
+            m_threshold[s] = c_one;
+            m_alias[s] = s;
+        }
+    }
+
+    template <typename UniformRandomBitGenerator>
+    std::size_t operator() (UniformRandomBitGenerator&& g) const {
+        const std::uint64_t draw = std::uniform_int_distribution<std::uint32_t>{}(g);
+        const auto product = draw * N;
+        const auto column = static_cast<std::size_t>(product >> 32);
+        return (product & (c_one - 1)) < m_threshold[column] ? column : m_alias[column];
+    }
+
+    //  Fills [first, last) with indices so batched simulations can draw many turns at once.
+    template <typename OutputIt, typename UniformRandomBitGenerator>
+    void Generate (OutputIt first, OutputIt last, UniformRandomBitGenerator&& g) const {
+        for (; first != last; ++first)
+            *first = static_cast<std::remove_reference_t<decltype(*first)>>((*this)(g));
+    }
+};
+
+template <std::size_t N>
+constexpr std::uint64_t AliasTable<N>::c_one;
+
+//--------------------------------------------------------------------------------------------------
+//  make_alias_table deduces the table size from its arguments, in the manner of make_array.
+//--------------------------------------------------------------------------------------------------
+template <typename... Ts>
+auto make_alias_table (Ts&&... weights) {
+    return AliasTable<sizeof...(Ts)>{ { { static_cast<double>(weights)... } } };
+}
+
+//--------------------------------------------------------------------------------------------------
+//  weighted_element selects one element of the range with the probabilities held by the table.
+//  The range must have exactly as many elements as the table has weights.
+//--------------------------------------------------------------------------------------------------
+template <typename InputIt, std::size_t N, typename UniformRandomBitGenerator>
+auto weighted_element (
+    InputIt first,
+    InputIt last,
+    const AliasTable<N>& table,
+    UniformRandomBitGenerator&& g
+) {
+    assert(static_cast<std::size_t>(std::distance(first, last)) == N);
+    (void)last;
+    return std::next(first, table(g));
+}
+
+//--------------------------------------------------------------------------------------------------
+//  draw_uint32 returns 32 uniformly random bits, calling the generator directly when its output
+//  already covers exactly that range, as std::mt19937's does.
+//--------------------------------------------------------------------------------------------------
+template <typename UniformRandomBitGenerator>
+std::uint32_t draw_uint32 (UniformRandomBitGenerator&& g) {
+    using G = std::decay_t<UniformRandomBitGenerator>;
+    if (G::min() == 0 && G::max() == std::numeric_limits<std::uint32_t>::max())
+        return static_cast<std::uint32_t>(g());
+    return std::uniform_int_distribution<std::uint32_t>{}(g);
+}
+
+//--------------------------------------------------------------------------------------------------
+//  generate_uniform fills [first, last) with integers uniformly distributed over [minimum, maximum]
+//  so that batched simulations can pre-generate the randomness for many turns at once.
+//  Words are drawn from the generator a block at a time and reduced to the range with Lemire's
+//  multiply-shift in a separate branch-free loop the compiler can vectorise; the rare biased
+//  products are redrawn afterwards. The sequence differs from std::uniform_int_distribution's.
+//  Ranges wider than 32 bits fall back to make_uniform_distribution.
+//--------------------------------------------------------------------------------------------------
+template <typename ForwardIt, typename T, typename UniformRandomBitGenerator>
+void generate_uniform (
+    ForwardIt first,
+    ForwardIt last,
+    const T& minimum,
+    const T& maximum,
+    UniformRandomBitGenerator&& g
+) {
+    static_assert(std::is_integral<T>::value, "generate_uniform requires an integral type");
+    using Value = typename std::iterator_traits<ForwardIt>::value_type;
+    constexpr std::size_t c_block = 128;
+    constexpr auto c_wordMax = std::uint64_t{std::numeric_limits<std::uint32_t>::max()};
+
+    const auto base = static_cast<std::uint64_t>(minimum);
+    const auto span = static_cast<std::uint64_t>(maximum) - base;
+    if (span > c_wordMax) {
+        auto&& dis = make_uniform_distribution(minimum, maximum);
+        std::generate(first, last, [&] { return static_cast<Value>(dis(g)); });
+        return;
+    }
+
+    const auto range = span + 1;
+    const auto threshold = static_cast<std::uint32_t>((c_wordMax + 1 - range) % range);
+    std::array<std::uint32_t, c_block> words;
+    std::array<std::uint64_t, c_block> products;
+    for (auto remaining = std::distance(first, last); remaining > 0; ) {
+        const auto count = static_cast<std::size_t>(
+            std::min<decltype(remaining)>(remaining, c_block)
+        );
+        for (std::size_t i = 0; i < count; ++i)
+            words[i] = draw_uint32(g);
+        for (std::size_t i = 0; i < count; ++i)
+            products[i] = words[i] * range;
+        for (std::size_t i = 0; i < count; ++i, ++first) {
+            while (static_cast<std::uint32_t>(products[i]) < threshold)
+                products[i] = draw_uint32(g) * range;
+            *first = static_cast<Value>(static_cast<T>(base + (products[i] >> 32)));
+        }
+        remaining -= count;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+//  generate_random_indices fills [first, last) with indices into a range of 'count' elements, e.g.
+//  spell selections for a whole batch of turns.
+//--------------------------------------------------------------------------------------------------
+template <typename ForwardIt, typename UniformRandomBitGenerator>
+void generate_random_indices (
+    ForwardIt first,
+    ForwardIt last,
+    std::size_t count,
+    UniformRandomBitGenerator&& g
+) {
+    assert(count > 0);
+    generate_uniform(first, last, std::size_t{0}, count - 1, g);
+}
+
+//--------------------------------------------------------------------------------------------------
+//  SplitMix64 is a uniform random bit generator with a single 64 bit word of state, small enough
+//  to give every player of a large simulation a stream of its own. Streams started from unrelated
+//  seeds (e.g. the output of another generator) are independent for all practical purposes.
+//  Each step is an add, three xor-shifts and two multiplies with no branches, so loops stepping
+//  many streams side by side can be vectorised. seed and default_seed follow the standard engines.
+//--------------------------------------------------------------------------------------------------
+struct SplitMix64 {
+    using result_type = std::uint64_t;
+    static constexpr result_type default_seed = 0;
+
+    std::uint64_t m_state{};
+
+    static constexpr result_type min () { return 0; }
+    static constexpr result_type max () { return std::numeric_limits<result_type>::max(); }
+
+    void seed (result_type value = default_seed) { m_state = value; }
+
+    static std::uint64_t Mix (std::uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+
+    result_type operator() () {
+        m_state += 0x9e3779b97f4a7c15ull;
+        return Mix(m_state);
+    }
+};
@@ -0,0 +1,146 @@
+//--------------------------------------------------------------------------------------------------
+//  Copyright 2016 Andy Bond
+// 
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//  
+//  http://www.apache.org/licenses/LICENSE-2.0
+//  
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//--------------------------------------------------------------------------------------------------
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+//--------------------------------------------------------------------------------------------------
+//  RunningStatistics accumulates the mean and variance of a stream of samples in constant space
+//  using Welford's algorithm, which stays accurate where the naive sum of squares would cancel.
+//--------------------------------------------------------------------------------------------------
+struct RunningStatistics {
+    std::size_t m_count{};
+    double m_mean{};
+    double m_m2{};      // Sum of squared differences from the mean
+
+    void Add (double x) {
+        ++m_count;
+        const auto delta = x - m_mean;
+        m_mean += delta / m_count;
+        m_m2 += delta * (x - m_mean);
+    }
+
+    // Combines two partial results exactly (Chan et al.), e.g. from separate threads or processes
+    void Merge (const RunningStatistics& other) {
+        if (other.m_count == 0)
+            return;
+        const auto count = m_count + other.m_count;
+        const auto delta = other.m_mean - m_mean;
+        m_mean += delta * other.m_count / count;
+        m_m2 += other.m_m2 + delta * delta * m_count * other.m_count / count;
+        m_count = count;
+    }
+
+    double Mean () const { return m_mean; }
+    double Variance () const { return m_count > 1 ? m_m2 / (m_count - 1) : 0.0; }
+    double StandardDeviation () const { return std::sqrt(Variance()); }
+    double StandardError () const {
+        return m_count > 0 ? StandardDeviation() / std::sqrt(static_cast<double>(m_count)) : 0.0;
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+//  student_t_95 is the two-sided 95% critical value of Student's t distribution. Degrees of
+//  freedom past the table use the first terms of the Cornish-Fisher expansion around the normal
+//  critical value, which is within 0.2% of the exact value from that point on.
+//--------------------------------------------------------------------------------------------------
+inline double student_t_95 (std::size_t degreesOfFreedom) {
+    static const std::array<double, 30> c_table = { {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+    } };
+    if (degreesOfFreedom == 0)
+        return std::numeric_limits<double>::infinity();
+    if (degreesOfFreedom <= c_table.size())
+        return c_table[degreesOfFreedom - 1];
+    return 1.959964 + 2.372 / degreesOfFreedom;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  relative_confidence_95 is the half width of the 95% confidence interval of the mean divided
+//  by the mean, i.e. 0.01 means the true mean is within +/-1% of the sample mean.
+//--------------------------------------------------------------------------------------------------
+inline double relative_confidence_95 (const RunningStatistics& s) {
+    if (s.m_count < 2 || s.Mean() == 0.0)
+        return std::numeric_limits<double>::infinity();
+    return student_t_95(s.m_count - 1) * s.StandardError() / std::abs(s.Mean());
+}
+
+//--------------------------------------------------------------------------------------------------
+//  QuantileSketch estimates quantiles of a stream of non-negative samples in constant space, after
+//  DDSketch: samples are counted in logarithmically sized bins, so any quantile it returns is
+//  within c_relativeAccuracy of a sample of that rank. The bins cover [c_minimum, ~6e11); zero has
+//  a bin of its own and samples outside the range are clamped into the end bins.
+//  Merging adds bin counts, so sketches from separate threads or processes combine without any
+//  further loss. It is trivially copyable and can live in shared memory.
+//--------------------------------------------------------------------------------------------------
+struct QuantileSketch {
+    static constexpr double c_relativeAccuracy = 0.01;
+    static constexpr double c_gamma = (1.0 + c_relativeAccuracy) / (1.0 - c_relativeAccuracy);
+    static constexpr double c_minimum = 1e-6;
+    static constexpr std::size_t c_binCount = 2048;
+
+    std::array<std::uint64_t, c_binCount> m_bins{};
+    std::uint64_t m_zeroCount{};
+    std::uint64_t m_count{};
+
+    static std::size_t BinOf (double x) {
+        const auto bin = std::ceil(std::log(x / c_minimum) / std::log(c_gamma));
+        return static_cast<std::size_t>(std::min(std::max(bin, 0.0), c_binCount - 1.0));
+    }
+
+    // The value which minimises the relative error across a bin
+    static double ValueOf (std::size_t bin) {
+        return 2.0 * c_minimum * std::pow(c_gamma, static_cast<double>(bin)) / (c_gamma + 1.0);
+    }
+
+    void Add (double x) {
+        ++m_count;
+        if (x <= 0.0)
+            ++m_zeroCount;
+        else
+            ++m_bins[BinOf(x)];
+    }
+
+    void Merge (const QuantileSketch& other) {
+        for (std::size_t i = 0; i < c_binCount; ++i)
+            m_bins[i] += other.m_bins[i];
+        m_zeroCount += other.m_zeroCount;
+        m_count += other.m_count;
+    }
+
+    // q in [0, 1]; 0.5 is the median. Returns 0 for an empty sketch.
+    double Quantile (double q) const {
+        if (m_count == 0)
+            return 0.0;
+        const auto rank = static_cast<std::uint64_t>(q * static_cast<double>(m_count - 1));
+        auto seen = m_zeroCount;
+        if (rank < seen)
+            return 0.0;
+        for (std::size_t i = 0; i < c_binCount; ++i) {
+            seen += m_bins[i];
+            if (rank < seen)
+                return ValueOf(i);
+        }
+        return ValueOf(c_binCount - 1);
+    }
+};
@@ -0,0 +1,315 @@
+//--------------------------------------------------------------------------------------------------
+//  Copyright 2016 Andy Bond
+// 
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//  
+//  http://www.apache.org/licenses/LICENSE-2.0
+//  
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//--------------------------------------------------------------------------------------------------
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/utsname.h>
+#endif
+
+#if defined(__linux__)
+#include <elf.h>
+#include <link.h>
+#endif
+
+//--------------------------------------------------------------------------------------------------
+//  Helpers for running benchmarks with as little interference from the system as possible, and
+//  for recording the parts of the system which still affect the results.
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+//  read_first_line returns the first line of a (typically /proc or /sys) file, or "" if it can't.
+//--------------------------------------------------------------------------------------------------
+inline std::string read_first_line (const std::string& path) {
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line);
+    return line;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  benchmark_cpus lists the CPUs this process may run on, ordered so that the first logical CPU
+//  of every physical core comes before any SMT sibling. Pinning N threads to the first N entries
+//  keeps them off each other's cores for as long as there are cores to go round.
+//--------------------------------------------------------------------------------------------------
+inline std::vector<std::size_t> benchmark_cpus () {
+    std::vector<std::size_t> allowed;
+#if defined(_WIN32)
+    DWORD_PTR process = 0;
+    DWORD_PTR system = 0;
+    if (GetProcessAffinityMask(GetCurrentProcess(), &process, &system)) {
+        for (std::size_t i = 0; i < sizeof(process) * 8; ++i) {
+            if (process & (DWORD_PTR{1} << i))
+                allowed.push_back(i);
+        }
+    }
+    return allowed;
+#else
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) != 0)
+        return allowed;
+    for (std::size_t i = 0; i < CPU_SETSIZE; ++i) {
+        if (CPU_ISSET(i, &set))
+            allowed.push_back(i);
+    }
+
+    //  A CPU is a core's primary thread when it is the first in its sibling list ("2,6" or "2-3").
+    const auto& isPrimary = [] (std::size_t cpu) {
+        const auto siblings = read_first_line(
+            "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/thread_siblings_list"
+        );
+        return siblings.empty() || std::stoul(siblings) == cpu;
+    };
+    (void)std::stable_partition(std::begin(allowed), std::end(allowed), isPrimary);
+    return allowed;
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+//  pin_current_thread restricts the calling thread to a single CPU.
+//--------------------------------------------------------------------------------------------------
+inline bool pin_current_thread (std::size_t cpu) {
+#if defined(_WIN32)
+    return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR{1} << cpu) != 0;
+#else
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+//  raise_process_priority asks for the highest priority an unprivileged process can usually get
+//  without risking the machine (no real-time classes). Lowering nice needs CAP_SYS_NICE on Linux.
+//--------------------------------------------------------------------------------------------------
+inline bool raise_process_priority () {
+#if defined(_WIN32)
+    return SetPriorityClass(GetCurrentProcess(), HIGH_PRIORITY_CLASS) != 0;
+#else
+    return setpriority(PRIO_PROCESS, 0, -20) == 0;
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+//  lock_process_memory keeps every current and future page resident so that no timing includes
+//  a page being swapped back in.
+//--------------------------------------------------------------------------------------------------
+inline bool lock_process_memory () {
+#if defined(_WIN32)
+    return false;
+#else
+    return mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+//  SystemEnvironment records what was running the benchmark. Fields which can't be determined on
+//  this platform are left as "unknown". capture_environment reports the governor and siblings of
+//  'cpu', the CPU the benchmark is pinned to.
+//--------------------------------------------------------------------------------------------------
+struct SystemEnvironment {
+    std::string m_cpuModel{"unknown"};
+    std::string m_governor{"unknown"};
+    std::string m_turbo{"unknown"};
+    std::string m_smt{"unknown"};
+    std::string m_siblings{"unknown"};  // Logical CPUs sharing a core with the benchmark's CPU
+    std::string m_kernel{"unknown"};
+    std::size_t m_cpuCount{};
+
+    //  True when the frequency is pinned: a performance governor and turbo disabled.
+    bool IsQuiet () const {
+        return m_governor == "performance" && m_turbo == "off";
+    }
+};
+
+inline SystemEnvironment capture_environment (std::size_t cpu = 0) {
+    SystemEnvironment env;
+    env.m_cpuCount = benchmark_cpus().size();
+#if !defined(_WIN32)
+    const auto& orUnknown = [] (std::string s) { return s.empty() ? std::string("unknown") : s; };
+
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    for (std::string line; std::getline(cpuinfo, line); ) {
+        if (line.compare(0, 10, "model name") == 0) {
+            const auto colon = line.find(':');
+            if (colon != std::string::npos)
+                env.m_cpuModel = orUnknown(line.substr(line.find_first_not_of(' ', colon + 1)));
+            break;
+        }
+    }
+
+    const auto cpuPath = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+    env.m_governor = orUnknown(read_first_line(cpuPath + "/cpufreq/scaling_governor"));
+
+    //  intel_pstate reports the inverse ("no_turbo"), acpi-cpufreq and amd-pstate report "boost".
+    const auto noTurbo = read_first_line("/sys/devices/system/cpu/intel_pstate/no_turbo");
+    const auto boost = read_first_line("/sys/devices/system/cpu/cpufreq/boost");
+    if (!noTurbo.empty())
+        env.m_turbo = noTurbo == "1" ? "off" : "on";
+    else if (!boost.empty())
+        env.m_turbo = boost == "1" ? "on" : "off";
+
+    const auto smt = read_first_line("/sys/devices/system/cpu/smt/active");
+    if (!smt.empty())
+        env.m_smt = smt == "1" ? "on" : "off";
+    env.m_siblings = orUnknown(read_first_line(cpuPath + "/topology/thread_siblings_list"));
+
+    utsname name;
+    if (uname(&name) == 0)
+        env.m_kernel = std::string(name.sysname) + " " + name.release;
+#endif
+    return env;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  peak_resident_bytes returns the largest resident set this process has had, or 0 if unknown.
+//  reset_peak_resident starts that high water mark again from the current resident set so that
+//  each phase of a benchmark can be measured on its own (Linux 4.0+; elsewhere it returns false
+//  and the peak covers the whole process).
+//--------------------------------------------------------------------------------------------------
+inline std::size_t peak_resident_bytes () {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return 0;
+    return counters.PeakWorkingSetSize;
+#else
+    std::ifstream status("/proc/self/status");
+    for (std::string line; std::getline(status, line); ) {
+        if (line.compare(0, 6, "VmHWM:") == 0)
+            return std::stoull(line.substr(6)) * 1024;  // Reported in kB
+    }
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+    return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+inline bool reset_peak_resident () {
+#if defined(_WIN32)
+    return false;
+#else
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    return static_cast<bool>(clearRefs << "5" << std::flush);
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+//  code_symbols lists the functions in the executable's ELF symbol table (Linux only, and empty
+//  once the executable is stripped), ordered by address. Names are as mangled.
+//  function_size returns the length in bytes of the machine code of the function starting at or
+//  containing 'address', or 0 if unknown. Windows looks it up in the x64 unwind tables.
+//--------------------------------------------------------------------------------------------------
+struct CodeSymbol {
+    std::uintptr_t m_address;
+    std::size_t m_size;
+    std::string m_name;
+};
+
+inline const std::vector<CodeSymbol>& code_symbols () {
+    static const auto& s_symbols = [] {
+        std::vector<CodeSymbol> symbols;
+#if defined(__linux__) && defined(__LP64__)
+        std::ifstream file("/proc/self/exe", std::ios::binary);
+        const std::vector<char> image{
+            std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()
+        };
+        Elf64_Ehdr header;
+        if (image.size() < sizeof(header))
+            return symbols;
+        std::memcpy(&header, image.data(), sizeof(header));
+        if (std::memcmp(header.e_ident, ELFMAG, SELFMAG) != 0 ||
+            header.e_ident[EI_CLASS] != ELFCLASS64)
+            return symbols;
+        const auto& section = [&] (std::size_t i) {
+            Elf64_Shdr section{};
+            const auto offset = header.e_shoff + i * sizeof(section);
+            if (i < header.e_shnum && offset + sizeof(section) <= image.size())
+                std::memcpy(&section, image.data() + offset, sizeof(section));
+            return section;
+        };
+
+        //  The load bias of the executable itself, which dl_iterate_phdr always reports first
+        std::uintptr_t bias = 0;
+        dl_iterate_phdr([] (dl_phdr_info* info, std::size_t, void* bias) {
+            *static_cast<std::uintptr_t*>(bias) = info->dlpi_addr;
+            return 1;
+        }, &bias);
+
+        for (std::size_t i = 0; i < header.e_shnum; ++i) {
+            const auto table = section(i);
+            const auto names = section(table.sh_link);
+            if (table.sh_type != SHT_SYMTAB || table.sh_offset + table.sh_size > image.size() ||
+                names.sh_offset + names.sh_size > image.size())
+                continue;
+            Elf64_Sym symbol;
+            for (std::size_t j = 0; j + sizeof(symbol) <= table.sh_size; j += sizeof(symbol)) {
+                std::memcpy(&symbol, image.data() + table.sh_offset + j, sizeof(symbol));
+                if (ELF64_ST_TYPE(symbol.st_info) != STT_FUNC || symbol.st_size == 0 ||
+                    symbol.st_name >= names.sh_size)
+                    continue;
+                const auto* name = image.data() + names.sh_offset + symbol.st_name;
+                const auto length = strnlen(name, names.sh_size - symbol.st_name);
+                symbols.push_back({bias + symbol.st_value, symbol.st_size, {name, length}});
+            }
+        }
+        std::sort(std::begin(symbols), std::end(symbols), [] (const auto& a, const auto& b) {
+            return a.m_address < b.m_address;
+        });
+#endif
+        return symbols;
+    }();
+    return s_symbols;
+}
+
+inline std::size_t function_size (const void* address) {
+    const auto target = reinterpret_cast<std::uintptr_t>(address);
+#if defined(_WIN64)
+    DWORD64 imageBase = 0;
+    const auto entry = RtlLookupFunctionEntry(target, &imageBase, nullptr);
+    return entry ? entry->EndAddress - entry->BeginAddress : 0;
+#else
+    const auto& symbols = code_symbols();
+    auto i = std::upper_bound(
+        std::begin(symbols), std::end(symbols), target,
+        [] (std::uintptr_t a, const CodeSymbol& b) { return a < b.m_address; }
+    );
+    if (i == std::begin(symbols))
+        return 0;
+    --i;
+    return target < i->m_address + i->m_size ? i->m_size : 0;
+#endif
+}
@@ -0,0 +1,197 @@
+//--------------------------------------------------------------------------------------------------
+//  Copyright 2016 Andy Bond
+// 
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//  
+//  http://www.apache.org/licenses/LICENSE-2.0
+//  
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//--------------------------------------------------------------------------------------------------
+#pragma once
+
+//--------------------------------------------------------------------------------------------------
+//  Scoped tracing which emits Chrome trace-event JSON (load it in chrome://tracing or Perfetto).
+//  Events are recorded into a buffer per thread, merged into one log when each thread exits and
+//  written to AUTOMAGIC_TRACE_FILE when the process exits.
+//
+//  AUTOMAGIC_TRACE_SCOPE is for coarse scopes and is always recorded.
+//  AUTOMAGIC_TRACE_DETAIL is for hot scopes (turns, spells); each coarse scope grants the thread a
+//  budget of AUTOMAGIC_TRACE_DETAIL_LIMIT detail events so that every game keeps a sample of its
+//  turns without the trace growing to hundreds of millions of events.
+//
+//  Everything compiles out unless AUTOMAGIC_TRACE is defined to a non-zero value.
+//--------------------------------------------------------------------------------------------------
+#ifndef AUTOMAGIC_TRACE
+#define AUTOMAGIC_TRACE 0
+#endif
+
+#ifndef AUTOMAGIC_TRACE_FILE
+#define AUTOMAGIC_TRACE_FILE "automagic_trace.json"
+#endif
+
+#ifndef AUTOMAGIC_TRACE_DETAIL_LIMIT
+#define AUTOMAGIC_TRACE_DETAIL_LIMIT 1024
+#endif
+
+#define AUTOMAGIC_TRACE_CONCAT_IMPL(a, b) a##b
+#define AUTOMAGIC_TRACE_CONCAT(a, b) AUTOMAGIC_TRACE_CONCAT_IMPL(a, b)
+
+#if AUTOMAGIC_TRACE
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <vector>
+
+//--------------------------------------------------------------------------------------------------
+struct TraceEvent {
+    const char* m_name;
+    std::uint64_t m_start;      // Nanoseconds since the log was created
+    std::uint64_t m_duration;   // Nanoseconds
+    std::uint32_t m_thread;
+};
+
+//--------------------------------------------------------------------------------------------------
+//  TraceLog is created by the first thread to trace and is destroyed after every thread_local
+//  buffer, so it always sees the complete set of events when it writes the file.
+//--------------------------------------------------------------------------------------------------
+struct TraceLog {
+    using Clock = std::chrono::steady_clock;
+
+    const Clock::time_point m_epoch{Clock::now()};
+    std::atomic<std::uint32_t> m_threadCount{};
+    std::mutex m_mutex;
+    std::vector<TraceEvent> m_events;
+    std::uint64_t m_dropped{};
+
+    static TraceLog& Get () {
+        static TraceLog s_log;
+        return s_log;
+    }
+
+    std::uint64_t Now () const {
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_epoch).count()
+        );
+    }
+
+    void Merge (std::vector<TraceEvent>& events, std::uint64_t dropped) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_events.insert(
+            std::end(m_events),
+            std::make_move_iterator(std::begin(events)),
+            std::make_move_iterator(std::end(events))
+        );
+        m_dropped += dropped;
+        events.clear();
+    }
+
+    ~TraceLog () {
+        std::ofstream file(AUTOMAGIC_TRACE_FILE);
+        if (!file)
+            return;
+
+        static const auto& microseconds = [] (std::uint64_t ns) {
+            return static_cast<double>(ns) / 1000.0;
+        };
+
+        file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+        auto separator = "\n";
+        for (std::uint32_t i = 0, c = m_threadCount; i != c; ++i) {
+            file << separator << R"({"name":"thread_name","ph":"M","pid":0,"tid":)" << i;
+            file << R"(,"args":{"name":"thread )" << i << "\"}}";
+            separator = ",\n";
+        }
+        file.precision(3);
+        file << std::fixed;
+        for (const auto& e : m_events) {
+            file << separator << R"({"name":")" << e.m_name << R"(","ph":"X","pid":0,"tid":)";
+            file << e.m_thread << ",\"ts\":" << microseconds(e.m_start);
+            file << ",\"dur\":" << microseconds(e.m_duration) << "}";
+        }
+        file << "\n],\"otherData\":{\"droppedDetailEvents\":" << m_dropped << "}}\n";
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+struct TraceBuffer {
+    TraceLog& m_log{TraceLog::Get()};
+    const std::uint32_t m_thread{m_log.m_threadCount++};
+    std::vector<TraceEvent> m_events;
+    std::uint64_t m_dropped{};
+    std::size_t m_detailBudget{};
+
+    static TraceBuffer& Get () {
+        static thread_local TraceBuffer t_buffer;
+        return t_buffer;
+    }
+
+    ~TraceBuffer () {
+        m_log.Merge(m_events, m_dropped);
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+//  TraceScope records a complete ("X") event covering its own lifetime.
+//--------------------------------------------------------------------------------------------------
+struct TraceScope {
+    TraceBuffer& m_buffer;
+    const char* const m_name;
+    const bool m_recorded;
+    const std::uint64_t m_start;
+
+    struct Coarse { };
+    struct Detail { };
+
+    TraceScope (const char* name, Coarse) :
+        m_buffer(TraceBuffer::Get()),
+        m_name(name),
+        m_recorded(true),
+        m_start(m_buffer.m_log.Now())
+    {
+        m_buffer.m_detailBudget = AUTOMAGIC_TRACE_DETAIL_LIMIT;
+    }
+
+    TraceScope (const char* name, Detail) :
+        m_buffer(TraceBuffer::Get()),
+        m_name(name),
+        m_recorded(m_buffer.m_detailBudget > 0),
+        m_start(m_recorded ? m_buffer.m_log.Now() : 0)
+    {
+        if (m_recorded)
+            --m_buffer.m_detailBudget;
+        else
+            ++m_buffer.m_dropped;
+    }
+
+    TraceScope (const TraceScope&) = delete;
+    TraceScope& operator= (const TraceScope&) = delete;
+
+    ~TraceScope () {
+        if (m_recorded) {
+            const auto duration = m_buffer.m_log.Now() - m_start;
+            m_buffer.m_events.push_back({m_name, m_start, duration, m_buffer.m_thread});
+        }
+    }
+};
+
+#define AUTOMAGIC_TRACE_SCOPE(name) \
+    const TraceScope AUTOMAGIC_TRACE_CONCAT(traceScope, __LINE__)((name), TraceScope::Coarse{})
+#define AUTOMAGIC_TRACE_DETAIL(name) \
+    const TraceScope AUTOMAGIC_TRACE_CONCAT(traceScope, __LINE__)((name), TraceScope::Detail{})
+
+#else
+
+#define AUTOMAGIC_TRACE_SCOPE(name) (void)0
+#define AUTOMAGIC_TRACE_DETAIL(name) (void)0
+
+#endif
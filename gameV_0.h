@@ -17,6 +17,9 @@
 
 #include "aux_array.h"
 #include "aux_numeric.h"
+#include "aux_random.h"
+#include "aux_trace.h"
+#include "spell_stats.h"
 #include <random>
 
 //--------------------------------------------------------------------------------------------------
@@ -28,30 +31,51 @@
 //--------------------------------------------------------------------------------------------------
 namespace Version0_0 {
 
+template <typename L = unsigned int>
 struct Game {
-    typedef unsigned int Life;
+    typedef L Life;
+    typedef uniform_distribution_t<Life> Distribution;
 
-    static const Life c_lifeMax = std::numeric_limits<Life>::max();
+    static constexpr Life c_lifeMax = capped_max<Life, unsigned int>();
     std::mt19937 m_engine;
     Life m_life;
 
     Game () : m_engine(), m_life(c_lifeMax) { }
+    void Reset (std::mt19937::result_type seed) {
+        m_engine.seed(seed);
+        m_life = c_lifeMax;
+    }
+    void Reset (const std::mt19937& engine) {
+        m_engine = engine;
+        m_life = c_lifeMax;
+    }
     Life& CastHeal (Life& life) {
-        std::uniform_int_distribution<Life> dis(0, c_lifeMax - life);
-        return life += dis(m_engine);
+        AUTOMAGIC_TRACE_DETAIL("Heal");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Heal, life);
+        Distribution dis(0, c_lifeMax - life);
+        return life = saturating_add(life, dis(m_engine));
     }
     Life& CastHurt (Life& life) {
-        std::uniform_int_distribution<Life> dis(0, life);
+        AUTOMAGIC_TRACE_DETAIL("Hurt");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Hurt, life);
+        Distribution dis(0, life);
         return life -= dis(m_engine);
     }
+    typedef Life& (Game::*Spell)(Life&);
+    static constexpr Spell c_spells[] = { &Game::CastHeal, &Game::CastHurt, };
+
     bool Turn () {
-        using Spells = Life& (Game::*[])(Life&);
-        static const Spells c_spells = { &Game::CastHeal, &Game::CastHurt, };
+        AUTOMAGIC_TRACE_DETAIL("Turn");
         std::uniform_int_distribution<size_t> dis(0, size_array(c_spells) - 1);
         return (this->*c_spells[dis(m_engine)])(m_life) > 0;
     }
 };
 
+template <typename L>
+constexpr typename Game<L>::Life Game<L>::c_lifeMax;
+template <typename L>
+constexpr typename Game<L>::Spell Game<L>::c_spells[];
+
 } // namespace Version0_0
 
 //--------------------------------------------------------------------------------------------------
@@ -59,23 +83,39 @@ struct Game {
 //--------------------------------------------------------------------------------------------------
 namespace Version1_0 {
 
+template <typename L = unsigned int>
 struct Game {
-    typedef unsigned int Life;
+    typedef L Life;
+    typedef uniform_distribution_t<Life> Distribution;
 
-    static const Life c_lifeMax = std::numeric_limits<Life>::max();
+    static constexpr Life c_lifeMax = capped_max<Life, unsigned int>();
     std::mt19937 m_engine;
     Life m_life;
 
     Game () : m_engine(), m_life(c_lifeMax) { }
+    void Reset (std::mt19937::result_type seed) {
+        m_engine.seed(seed);
+        m_life = c_lifeMax;
+    }
+    void Reset (const std::mt19937& engine) {
+        m_engine = engine;
+        m_life = c_lifeMax;
+    }
     Life& CastHeal (Life& life) {
-        std::uniform_int_distribution<Life> dis(0, c_lifeMax - life);
-        return life += dis(m_engine);
+        AUTOMAGIC_TRACE_DETAIL("Heal");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Heal, life);
+        Distribution dis(0, c_lifeMax - life);
+        return life = saturating_add(life, dis(m_engine));
     }
     Life& CastHurt (Life& life) {
-        std::uniform_int_distribution<Life> dis(0, life);
+        AUTOMAGIC_TRACE_DETAIL("Hurt");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Hurt, life);
+        Distribution dis(0, life);
         return life -= dis(m_engine);
     }
     Life& CastMaim (Life& life) {
+        AUTOMAGIC_TRACE_DETAIL("Maim");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Maim, life);
         Life change;
         if (life > c_lifeMax / 100 * 80)            // (80, 100]%
             change = c_lifeMax / 100 * 25;
@@ -89,14 +129,21 @@ struct Game {
             change = 0;
         return life -= change;
     }
+    typedef Life& (Game::*Spell)(Life&);
+    static constexpr Spell c_spells[] = { &Game::CastHeal, &Game::CastHurt, &Game::CastMaim };
+
     bool Turn () {
-        using Spells = Life& (Game::*[])(Life&);
-        static const Spells c_spells = { &Game::CastHeal, &Game::CastHurt, &Game::CastMaim };
+        AUTOMAGIC_TRACE_DETAIL("Turn");
         std::uniform_int_distribution<size_t> dis(0, size_array(c_spells) - 1);
         return (this->*c_spells[dis(m_engine)])(m_life) > 0;
     }
 };
 
+template <typename L>
+constexpr typename Game<L>::Life Game<L>::c_lifeMax;
+template <typename L>
+constexpr typename Game<L>::Spell Game<L>::c_spells[];
+
 } // namespace Version1_0
 
 //--------------------------------------------------------------------------------------------------
@@ -104,10 +151,12 @@ struct Game {
 //--------------------------------------------------------------------------------------------------
 namespace Version2_0 {
 
+template <typename L = unsigned int>
 struct Game {
-    typedef unsigned int Life;
+    typedef L Life;
+    typedef uniform_distribution_t<Life> Distribution;
 
-    static const Life c_lifeMax = std::numeric_limits<Life>::max();
+    static constexpr Life c_lifeMax = capped_max<Life, unsigned int>();
     std::mt19937 m_engine;
     Life m_life;
 
@@ -116,15 +165,29 @@ struct Game {
     }
 
     Game () : m_engine(), m_life(c_lifeMax) { }
+    void Reset (std::mt19937::result_type seed) {
+        m_engine.seed(seed);
+        m_life = c_lifeMax;
+    }
+    void Reset (const std::mt19937& engine) {
+        m_engine = engine;
+        m_life = c_lifeMax;
+    }
     Life& CastHeal (Life& life) {
-        std::uniform_int_distribution<Life> dis(0, c_lifeMax - life);
-        return life += dis(m_engine);
+        AUTOMAGIC_TRACE_DETAIL("Heal");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Heal, life);
+        Distribution dis(0, c_lifeMax - life);
+        return life = saturating_add(life, dis(m_engine));
     }
     Life& CastHurt (Life& life) {
-        std::uniform_int_distribution<Life> dis(0, life);
+        AUTOMAGIC_TRACE_DETAIL("Hurt");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Hurt, life);
+        Distribution dis(0, life);
         return life -= dis(m_engine);
     }
     Life& CastMaim (Life& life) {
+        AUTOMAGIC_TRACE_DETAIL("Maim");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Maim, life);
         Life change;
         if (life > c_lifeMax / 100 * 80)            // (80, 100]%
             change = c_lifeMax / 100 * 25;
@@ -139,22 +202,32 @@ struct Game {
         return life -= change;
     }
     Life& CastRend (Life& life) {
-        std::uniform_int_distribution<Life> dis(0, c_lifeMax);
-        return life /= CalcGCD(life, dis(m_engine));
+        AUTOMAGIC_TRACE_DETAIL("Rend");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Rend, life);
+        Distribution dis(0, c_lifeMax);
+        const Life divisor = CalcGCD(life, dis(m_engine));
+        return divisor > Life() ? life /= divisor : life;
     }
+    typedef Life& (Game::*Spell)(Life&);
+    static constexpr Spell c_spells[] = {
+        &Game::CastHeal, 
+        &Game::CastHurt, 
+        &Game::CastMaim,
+        &Game::CastRend,
+    };
+
     bool Turn () {
-        using Spells = Life& (Game::*[])(Life&);
-        static const Spells c_spells = {
-            &Game::CastHeal, 
-            &Game::CastHurt, 
-            &Game::CastMaim,
-            &Game::CastRend,
-        };
+        AUTOMAGIC_TRACE_DETAIL("Turn");
         std::uniform_int_distribution<size_t> dis(0, size_array(c_spells) - 1);
         return (this->*c_spells[dis(m_engine)])(m_life) > 0;
     }
 };
 
+template <typename L>
+constexpr typename Game<L>::Life Game<L>::c_lifeMax;
+template <typename L>
+constexpr typename Game<L>::Spell Game<L>::c_spells[];
+
 } // namespace Version2_0
 
 //--------------------------------------------------------------------------------------------------
@@ -162,15 +235,17 @@ struct Game {
 //--------------------------------------------------------------------------------------------------
 namespace Version3_0 {
 
+template <typename L = unsigned int>
 struct Game {
     enum {
         c_playerCount = 4u,
     };
 
-    typedef unsigned int Life;
+    typedef L Life;
     typedef std::array<Life, c_playerCount> LifeArray;
+    typedef uniform_distribution_t<Life> Distribution;
 
-    static const Life c_lifeMax = std::numeric_limits<Life>::max();
+    static constexpr Life c_lifeMax = capped_max<Life, unsigned int>();
     std::mt19937 m_engine;
     LifeArray m_life;
 
@@ -181,15 +256,29 @@ struct Game {
     Game () : m_engine() {
         m_life.fill(c_lifeMax);
     }
+    void Reset (std::mt19937::result_type seed) {
+        m_engine.seed(seed);
+        m_life.fill(c_lifeMax);
+    }
+    void Reset (const std::mt19937& engine) {
+        m_engine = engine;
+        m_life.fill(c_lifeMax);
+    }
     Life& CastHeal (Life& life) {
-        std::uniform_int_distribution<Life> dis(0, c_lifeMax - life);
-        return life += dis(m_engine);
+        AUTOMAGIC_TRACE_DETAIL("Heal");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Heal, life);
+        Distribution dis(0, c_lifeMax - life);
+        return life = saturating_add(life, dis(m_engine));
     }
     Life& CastHurt (Life& life) {
-        std::uniform_int_distribution<Life> dis(0, life);
+        AUTOMAGIC_TRACE_DETAIL("Hurt");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Hurt, life);
+        Distribution dis(0, life);
         return life -= dis(m_engine);
     }
     Life& CastMaim (Life& life) {
+        AUTOMAGIC_TRACE_DETAIL("Maim");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Maim, life);
         Life change;
         if (life > c_lifeMax / 100 * 80)            // (80, 100]%
             change = c_lifeMax / 100 * 25;
@@ -204,21 +293,26 @@ struct Game {
         return life -= change;
     }
     Life& CastRend (Life& life) {
-        std::uniform_int_distribution<Life> dis(0, c_lifeMax);
-        return life /= CalcGCD(life, dis(m_engine));
+        AUTOMAGIC_TRACE_DETAIL("Rend");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Rend, life);
+        Distribution dis(0, c_lifeMax);
+        const Life divisor = CalcGCD(life, dis(m_engine));
+        return divisor > Life() ? life /= divisor : life;
     }
+    typedef Life& (Game::*Spell)(Life&);
+    static constexpr Spell c_spells[] = {
+        &Game::CastHeal, 
+        &Game::CastHurt, 
+        //&Game::CastMaim,
+        //&Game::CastRend,
+    };
+
     bool Turn () {
-        using Spells = Life& (Game::*[])(Life&);
-        static const Spells c_spells = {
-            &Game::CastHeal, 
-            &Game::CastHurt, 
-            //&Game::CastMaim,
-            //&Game::CastRend,
-        };
+        AUTOMAGIC_TRACE_DETAIL("Turn");
         std::uniform_int_distribution<size_t> dis(0, size_array(c_spells) - 1);
 
         bool anyAlive = false;
-        for (LifeArray::value_type& i : m_life) {
+        for (typename LifeArray::value_type& i : m_life) {
             if (i > 0)
                 anyAlive = (this->*c_spells[dis(m_engine)])(i) > 0 || anyAlive;
         }
@@ -226,4 +320,9 @@ struct Game {
     }
 };
 
+template <typename L>
+constexpr typename Game<L>::Life Game<L>::c_lifeMax;
+template <typename L>
+constexpr typename Game<L>::Spell Game<L>::c_spells[];
+
 } // namespace Version3_0
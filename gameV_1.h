@@ -18,6 +18,8 @@
 #include "aux_array.h"
 #include "aux_numeric.h"
 #include "aux_random.h"
+#include "aux_trace.h"
+#include "spell_stats.h"
 
 //--------------------------------------------------------------------------------------------------
 //  C++11 AAA (MSVC2010 compatible)
@@ -28,29 +30,50 @@
 //--------------------------------------------------------------------------------------------------
 namespace Version0_1 {
 
+template <typename L = unsigned int>
 struct Game {
-    typedef unsigned int Life;
+    typedef L Life;
 
-    static const auto c_lifeMax = std::numeric_limits<Life>::max();
+    static constexpr Life c_lifeMax = capped_max<Life, unsigned int>();
     std::mt19937 m_engine;
     Life m_life;
 
     Game () : m_engine(), m_life(c_lifeMax) { }
+    auto Reset (typename decltype(m_engine)::result_type seed) -> void {
+        m_engine.seed(seed);
+        m_life = c_lifeMax;
+    }
+    auto Reset (const decltype(m_engine)& engine) -> void {
+        m_engine = engine;
+        m_life = c_lifeMax;
+    }
     auto CastHeal (Life& life) -> decltype(life) {
+        AUTOMAGIC_TRACE_DETAIL("Heal");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Heal, life);
         auto dis = make_uniform_distribution(0, c_lifeMax - life);
-        return life += dis(m_engine);
+        return life = saturating_add(life, dis(m_engine));
     }
     auto CastHurt (Life& life) -> decltype(life) {
+        AUTOMAGIC_TRACE_DETAIL("Hurt");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Hurt, life);
         auto dis = make_uniform_distribution(0, life);
         return life -= dis(m_engine);
     }
+    using Spell = decltype(&Game::CastHeal);
+    static constexpr Spell c_spells[] = { &Game::CastHeal, &Game::CastHurt, };
+
     auto Turn () -> decltype(m_life > 0) {
-        static const auto& c_spells = { &Game::CastHeal, &Game::CastHurt, };
+        AUTOMAGIC_TRACE_DETAIL("Turn");
         auto dis = make_uniform_distribution(0, size_array(c_spells) - 1);
-        return (this->*(c_spells.begin())[dis(m_engine)])(m_life) > 0;
+        return (this->*c_spells[dis(m_engine)])(m_life) > 0;
     }
 };
 
+template <typename L>
+constexpr typename Game<L>::Life Game<L>::c_lifeMax;
+template <typename L>
+constexpr typename Game<L>::Spell Game<L>::c_spells[];
+
 } // namespace Version0_1
 
 //--------------------------------------------------------------------------------------------------
@@ -58,23 +81,38 @@ struct Game {
 //--------------------------------------------------------------------------------------------------
 namespace Version1_1 {
 
+template <typename L = unsigned int>
 struct Game {
-    typedef unsigned int Life;
+    typedef L Life;
 
-    static const auto c_lifeMax = std::numeric_limits<Life>::max();
+    static constexpr Life c_lifeMax = capped_max<Life, unsigned int>();
     std::mt19937 m_engine;
     Life m_life;
 
     Game () : m_engine(), m_life(c_lifeMax) { }
+    auto Reset (typename decltype(m_engine)::result_type seed) -> void {
+        m_engine.seed(seed);
+        m_life = c_lifeMax;
+    }
+    auto Reset (const decltype(m_engine)& engine) -> void {
+        m_engine = engine;
+        m_life = c_lifeMax;
+    }
     auto CastHeal (Life& life) -> decltype(life) {
+        AUTOMAGIC_TRACE_DETAIL("Heal");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Heal, life);
         auto dis = make_uniform_distribution(0, c_lifeMax - life);
-        return life += dis(m_engine);
+        return life = saturating_add(life, dis(m_engine));
     }
     auto CastHurt (Life& life) -> decltype(life) {
+        AUTOMAGIC_TRACE_DETAIL("Hurt");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Hurt, life);
         auto dis = make_uniform_distribution(0, life);
         return life -= dis(m_engine);
     }
     auto CastMaim (Life& life) -> decltype(life) {
+        AUTOMAGIC_TRACE_DETAIL("Maim");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Maim, life);
         typename std::remove_reference<decltype(life)>::type change;
         if (life > c_lifeMax / 100 * 80)            // (80, 100]%
             change = c_lifeMax / 100 * 25;
@@ -88,13 +126,21 @@ struct Game {
             change = 0;
         return life -= change;
     }
+    using Spell = decltype(&Game::CastHeal);
+    static constexpr Spell c_spells[] = { &Game::CastHeal, &Game::CastHurt, &Game::CastMaim, };
+
     auto Turn () -> decltype(m_life > 0) {
-        static const auto& c_spells = { &Game::CastHeal, &Game::CastHurt, &Game::CastMaim, };
+        AUTOMAGIC_TRACE_DETAIL("Turn");
         auto dis = make_uniform_distribution(0, size_array(c_spells) - 1);
-        return (this->*(c_spells.begin())[dis(m_engine)])(m_life) > 0;
+        return (this->*c_spells[dis(m_engine)])(m_life) > 0;
     }
 };
 
+template <typename L>
+constexpr typename Game<L>::Life Game<L>::c_lifeMax;
+template <typename L>
+constexpr typename Game<L>::Spell Game<L>::c_spells[];
+
 } // namespace Version1_1
 
 //--------------------------------------------------------------------------------------------------
@@ -102,10 +148,11 @@ struct Game {
 //--------------------------------------------------------------------------------------------------
 namespace Version2_1 {
 
+template <typename L = unsigned int>
 struct Game {
-    typedef unsigned int Life;
+    typedef L Life;
 
-    static const auto c_lifeMax = std::numeric_limits<Life>::max();
+    static constexpr Life c_lifeMax = capped_max<Life, unsigned int>();
     std::mt19937 m_engine;
     Life m_life;
 
@@ -114,15 +161,29 @@ struct Game {
     }
 
     Game () : m_engine(), m_life(c_lifeMax) { }
+    auto Reset (typename decltype(m_engine)::result_type seed) -> void {
+        m_engine.seed(seed);
+        m_life = c_lifeMax;
+    }
+    auto Reset (const decltype(m_engine)& engine) -> void {
+        m_engine = engine;
+        m_life = c_lifeMax;
+    }
     auto CastHeal (Life& life) -> decltype(life) {
+        AUTOMAGIC_TRACE_DETAIL("Heal");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Heal, life);
         auto dis = make_uniform_distribution(0, c_lifeMax - life);
-        return life += dis(m_engine);
+        return life = saturating_add(life, dis(m_engine));
     }
     auto CastHurt (Life& life) -> decltype(life) {
+        AUTOMAGIC_TRACE_DETAIL("Hurt");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Hurt, life);
         auto dis = make_uniform_distribution(0, life);
         return life -= dis(m_engine);
     }
     auto CastMaim (Life& life) -> decltype(life) {
+        AUTOMAGIC_TRACE_DETAIL("Maim");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Maim, life);
         typename std::remove_reference<decltype(life)>::type change;
         if (life > c_lifeMax / 100 * 80)            // (80, 100]%
             change = c_lifeMax / 100 * 25;
@@ -136,22 +197,37 @@ struct Game {
             change = 0;
         return life -= change;
     }
+    struct RendBounds {
+        static constexpr auto min () -> Life { return 0; }
+        static constexpr auto max () -> Life { return c_lifeMax; }
+    };
     auto CastRend (Life& life) -> decltype(life) {
-        auto dis = make_uniform_distribution(0, c_lifeMax);
-        return life /= CalcGCD(life, dis(m_engine));
+        AUTOMAGIC_TRACE_DETAIL("Rend");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Rend, life);
+        auto dis = BoundedUniformDistribution<Life, RendBounds>{};
+        auto divisor = CalcGCD(life, dis(m_engine));
+        return divisor > decltype(divisor)() ? life /= divisor : life;
     }
+    using Spell = decltype(&Game::CastHeal);
+    static constexpr Spell c_spells[] = {
+        &Game::CastHeal,
+        &Game::CastHurt,
+        &Game::CastMaim,
+        &Game::CastRend,
+    };
+
     auto Turn () -> decltype(m_life > 0) {
-        static const auto& c_spells = {
-            &Game::CastHeal,
-            &Game::CastHurt,
-            &Game::CastMaim,
-            &Game::CastRend,
-        };
+        AUTOMAGIC_TRACE_DETAIL("Turn");
         auto dis = make_uniform_distribution(0, size_array(c_spells) - 1);
-        return (this->*(c_spells.begin())[dis(m_engine)])(m_life) > 0;
+        return (this->*c_spells[dis(m_engine)])(m_life) > 0;
     }
 };
 
+template <typename L>
+constexpr typename Game<L>::Life Game<L>::c_lifeMax;
+template <typename L>
+constexpr typename Game<L>::Spell Game<L>::c_spells[];
+
 } // namespace Version2_1
 
 //--------------------------------------------------------------------------------------------------
@@ -159,12 +235,13 @@ struct Game {
 //--------------------------------------------------------------------------------------------------
 namespace Version3_1 {
 
+template <typename L = unsigned int>
 struct Game {
-    typedef unsigned int Life;
+    typedef L Life;
     static const auto c_playerCount = 4u;
     typedef std::array<Life, c_playerCount> LifeArray;
 
-    static const auto c_lifeMax = std::numeric_limits<Life>::max();
+    static constexpr Life c_lifeMax = capped_max<Life, unsigned int>();
     std::mt19937 m_engine;
     LifeArray m_life;
 
@@ -175,15 +252,29 @@ struct Game {
     Game () : m_engine() {
         m_life.fill(c_lifeMax);
     }
+    auto Reset (typename decltype(m_engine)::result_type seed) -> void {
+        m_engine.seed(seed);
+        m_life.fill(c_lifeMax);
+    }
+    auto Reset (const decltype(m_engine)& engine) -> void {
+        m_engine = engine;
+        m_life.fill(c_lifeMax);
+    }
     auto CastHeal (Life& life) -> decltype(life) {
+        AUTOMAGIC_TRACE_DETAIL("Heal");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Heal, life);
         auto dis = make_uniform_distribution(0, c_lifeMax - life);
-        return life += dis(m_engine);
+        return life = saturating_add(life, dis(m_engine));
     }
     auto CastHurt (Life& life) -> decltype(life) {
+        AUTOMAGIC_TRACE_DETAIL("Hurt");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Hurt, life);
         auto dis = make_uniform_distribution(0, life);
         return life -= dis(m_engine);
     }
     auto CastMaim (Life& life) -> decltype(life) {
+        AUTOMAGIC_TRACE_DETAIL("Maim");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Maim, life);
         typename std::remove_reference<decltype(life)>::type change;
         if (life > c_lifeMax / 100 * 80)            // (80, 100]%
             change = c_lifeMax / 100 * 25;
@@ -197,26 +288,41 @@ struct Game {
             change = 0;
         return life -= change;
     }
+    struct RendBounds {
+        static constexpr auto min () -> Life { return 0; }
+        static constexpr auto max () -> Life { return c_lifeMax; }
+    };
     auto CastRend (Life& life) -> decltype(life) {
-        auto dis = make_uniform_distribution(0, c_lifeMax);
-        return life /= CalcGCD(life, dis(m_engine));
+        AUTOMAGIC_TRACE_DETAIL("Rend");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Rend, life);
+        auto dis = BoundedUniformDistribution<Life, RendBounds>{};
+        auto divisor = CalcGCD(life, dis(m_engine));
+        return divisor > decltype(divisor)() ? life /= divisor : life;
     }
+    using Spell = decltype(&Game::CastHeal);
+    static constexpr Spell c_spells[] = {
+        &Game::CastHeal,
+        &Game::CastHurt,
+        //&Game::CastMaim,
+        //&Game::CastRend,
+    };
+
     auto Turn () -> decltype(m_life[0] > 0) {
-        static const auto& c_spells = {
-            &Game::CastHeal,
-            &Game::CastHurt,
-            //&Game::CastMaim,
-            //&Game::CastRend,
-        };
+        AUTOMAGIC_TRACE_DETAIL("Turn");
         auto dis = make_uniform_distribution(0, size_array(c_spells) - 1);
 
         auto anyAlive = false;
         for (auto i = m_life.begin(), c = m_life.end(); i != c; ++i) {
             if (*i > 0)
-                anyAlive = (this->*(c_spells.begin())[dis(m_engine)])(*i) > 0 || anyAlive;
+                anyAlive = (this->*c_spells[dis(m_engine)])(*i) > 0 || anyAlive;
         }
         return anyAlive;
     }
 };
 
+template <typename L>
+constexpr typename Game<L>::Life Game<L>::c_lifeMax;
+template <typename L>
+constexpr typename Game<L>::Spell Game<L>::c_spells[];
+
 } // namespace Version3_1
@@ -19,7 +19,10 @@
 #include "aux_array.h"
 #include "aux_iterator.h"
 #include "aux_numeric.h"
+#include "aux_parallel.h"
 #include "aux_random.h"
+#include "aux_trace.h"
+#include "spell_stats.h"
 
 //--------------------------------------------------------------------------------------------------
 //  C++14 AAA
@@ -30,30 +33,50 @@
 //--------------------------------------------------------------------------------------------------
 namespace Version0_2 {
 
+template <typename L = unsigned int>
 struct Game {
-    using Life = unsigned int;
+    using Life = L;
 
-    static constexpr auto c_lifeMax = std::numeric_limits<Life>::max();
+    static constexpr Life c_lifeMax = capped_max<Life, unsigned int>();
     std::mt19937 m_engine{};
     Life m_life{c_lifeMax};
 
+    auto Reset (typename decltype(m_engine)::result_type seed) {
+        m_engine.seed(seed);
+        m_life = c_lifeMax;
+    }
+    auto Reset (const decltype(m_engine)& engine) {
+        m_engine = engine;
+        m_life = c_lifeMax;
+    }
+
+    static auto CastHeal (Life& life, decltype(m_engine)& engine) -> decltype(life) {
+        AUTOMAGIC_TRACE_DETAIL("Heal");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Heal, life);
+        auto&& dis = make_uniform_distribution(0, c_lifeMax - life);
+        return life = saturating_add(life, dis(engine));
+    }
+    static auto CastHurt (Life& life, decltype(m_engine)& engine) -> decltype(life) {
+        AUTOMAGIC_TRACE_DETAIL("Hurt");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Hurt, life);
+        auto&& dis = make_uniform_distribution(0, life);
+        return life -= dis(engine);
+    }
+    using Spell = decltype(&Game::CastHeal);
+    static constexpr Spell c_spells[] = { &Game::CastHeal, &Game::CastHurt, };
+
     auto Turn () {
-        using Spell = decltype(m_life)& (*)(decltype(m_life)&, decltype(m_engine)&);
-        static const auto c_spells = make_array<Spell>(
-            [] (auto& life, auto& engine) -> auto& { //  Heal
-                auto&& dis = make_uniform_distribution(0, c_lifeMax - life);
-                return life += dis(engine);
-            },
-            [] (auto& life, auto& engine) -> auto& { //  Hurt
-                auto&& dis = make_uniform_distribution(0, life);
-                return life -= dis(engine);
-            }
-        );
+        AUTOMAGIC_TRACE_DETAIL("Turn");
         auto&& spell = random_element(std::begin(c_spells), std::end(c_spells), m_engine);
         return (*spell)(m_life, m_engine) > 0;
     }
 };
 
+template <typename L>
+constexpr typename Game<L>::Life Game<L>::c_lifeMax;
+template <typename L>
+constexpr typename Game<L>::Spell Game<L>::c_spells[];
+
 } // namespace Version0_2
 
 //--------------------------------------------------------------------------------------------------
@@ -61,43 +84,65 @@ struct Game {
 //--------------------------------------------------------------------------------------------------
 namespace Version1_2 {
 
+template <typename L = unsigned int>
 struct Game {
-    using Life = unsigned int;
+    using Life = L;
 
-    static constexpr auto c_lifeMax = std::numeric_limits<Life>::max();
+    static constexpr Life c_lifeMax = capped_max<Life, unsigned int>();
     std::mt19937 m_engine{};
     Life m_life{c_lifeMax};
 
+    auto Reset (typename decltype(m_engine)::result_type seed) {
+        m_engine.seed(seed);
+        m_life = c_lifeMax;
+    }
+    auto Reset (const decltype(m_engine)& engine) {
+        m_engine = engine;
+        m_life = c_lifeMax;
+    }
+
+    static auto CastHeal (Life& life, decltype(m_engine)& engine) -> decltype(life) {
+        AUTOMAGIC_TRACE_DETAIL("Heal");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Heal, life);
+        auto&& dis = make_uniform_distribution(0, c_lifeMax - life);
+        return life = saturating_add(life, dis(engine));
+    }
+    static auto CastHurt (Life& life, decltype(m_engine)& engine) -> decltype(life) {
+        AUTOMAGIC_TRACE_DETAIL("Hurt");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Hurt, life);
+        auto&& dis = make_uniform_distribution(0, life);
+        return life -= dis(engine);
+    }
+    static auto CastMaim (Life& life, decltype(m_engine)&) -> decltype(life) {
+        AUTOMAGIC_TRACE_DETAIL("Maim");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Maim, life);
+        auto&& change = choose(
+            [&life] { return life > c_lifeMax / 100 * 80; },    // (80, 100]%
+            [] { return c_lifeMax / 100 * 25; },
+            [&life] { return life > c_lifeMax / 100 * 60; },    // (60, 80]%
+            [] { return c_lifeMax / 100 * 20; },
+            [&life] { return life > c_lifeMax / 100 * 40; },    // (40, 60]%
+            [] { return c_lifeMax / 100 * 15; },
+            [&life] { return life > c_lifeMax / 100 * 20; },    // (20, 40]%
+            [] { return c_lifeMax / 100 * 10; }
+        );                                                      // [0, 20]%
+        return life -= change;
+    }
+    using Spell = decltype(&Game::CastHeal);
+    static constexpr Spell c_spells[] = { &Game::CastHeal, &Game::CastHurt, &Game::CastMaim, };
+
     auto Turn () {
-        using Spell = decltype(m_life)& (*)(decltype(m_life)&, decltype(m_engine)&);
-        static const auto c_spells = make_array<Spell>(
-            [] (auto& life, auto& engine) -> auto& {    //  Heal
-                auto&& dis = make_uniform_distribution(0, c_lifeMax - life);
-                return life += dis(engine);
-            }, 
-            [] (auto& life, auto& engine) -> auto& {    //  Hurt
-                auto&& dis = make_uniform_distribution(0, life);
-                return life -= dis(engine);
-            }, 
-            [] (auto& life, auto&) -> auto& {           //  Maim
-                auto&& change = choose(
-                    [&life] { return life > c_lifeMax / 100 * 80; },    // (80, 100]%
-                    [] { return c_lifeMax / 100 * 25; },
-                    [&life] { return life > c_lifeMax / 100 * 60; },    // (60, 80]%
-                    [] { return c_lifeMax / 100 * 20; },
-                    [&life] { return life > c_lifeMax / 100 * 40; },    // (40, 60]%
-                    [] { return c_lifeMax / 100 * 15; },
-                    [&life] { return life > c_lifeMax / 100 * 20; },    // (20, 40]%
-                    [] { return c_lifeMax / 100 * 10; }
-                );                                                      // [0, 20]%
-                return life -= change;
-            }
-        );
+        AUTOMAGIC_TRACE_DETAIL("Turn");
         auto&& spell = random_element(std::begin(c_spells), std::end(c_spells), m_engine);
         return (*spell)(m_life, m_engine) > 0;
     }
 };
 
+template <typename L>
+constexpr typename Game<L>::Life Game<L>::c_lifeMax;
+template <typename L>
+constexpr typename Game<L>::Spell Game<L>::c_spells[];
+
 } // namespace Version1_2
 
 //--------------------------------------------------------------------------------------------------
@@ -105,55 +150,89 @@ struct Game {
 //--------------------------------------------------------------------------------------------------
 namespace Version2_2 {
 
+template <typename L = unsigned int>
 struct Game {
-    using Life = unsigned int;
+    using Life = L;
 
-    static constexpr auto c_lifeMax = std::numeric_limits<Life>::max();
+    static constexpr Life c_lifeMax = capped_max<Life, unsigned int>();
     std::mt19937 m_engine{};
     Life m_life{c_lifeMax};
 
-    auto Turn () {
-        using Spell = decltype(m_life)& (*)(decltype(m_life)&, decltype(m_engine)&);
-        static const auto c_spells = make_array<Spell>(
-            [] (auto& life, auto& engine) -> auto& {    //  Heal
-                auto&& dis = make_uniform_distribution(0, c_lifeMax - life);
-                return life += dis(engine);
-            }, 
-            [] (auto& life, auto& engine) -> auto& {    //  Hurt
-                auto&& dis = make_uniform_distribution(0, life);
-                return life -= dis(engine);
-            }, 
-            [] (auto& life, auto&) -> auto& {           //  Maim
-                auto&& change = choose(
-                    [&life] { return life > c_lifeMax / 100 * 80; },    // (80, 100]%
-                    [] { return c_lifeMax / 100 * 25; },
-                    [&life] { return life > c_lifeMax / 100 * 60; },    // (60, 80]%
-                    [] { return c_lifeMax / 100 * 20; },
-                    [&life] { return life > c_lifeMax / 100 * 40; },    // (40, 60]%
-                    [] { return c_lifeMax / 100 * 15; },
-                    [&life] { return life > c_lifeMax / 100 * 20; },    // (20, 40]%
-                    [] { return c_lifeMax / 100 * 10; }
-                );                                                      // [0, 20]%
-                return life -= change;
+    auto Reset (typename decltype(m_engine)::result_type seed) {
+        m_engine.seed(seed);
+        m_life = c_lifeMax;
+    }
+    auto Reset (const decltype(m_engine)& engine) {
+        m_engine = engine;
+        m_life = c_lifeMax;
+    }
+
+    static auto CastHeal (Life& life, decltype(m_engine)& engine) -> decltype(life) {
+        AUTOMAGIC_TRACE_DETAIL("Heal");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Heal, life);
+        auto&& dis = make_uniform_distribution(0, c_lifeMax - life);
+        return life = saturating_add(life, dis(engine));
+    }
+    static auto CastHurt (Life& life, decltype(m_engine)& engine) -> decltype(life) {
+        AUTOMAGIC_TRACE_DETAIL("Hurt");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Hurt, life);
+        auto&& dis = make_uniform_distribution(0, life);
+        return life -= dis(engine);
+    }
+    static auto CastMaim (Life& life, decltype(m_engine)&) -> decltype(life) {
+        AUTOMAGIC_TRACE_DETAIL("Maim");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Maim, life);
+        auto&& change = choose(
+            [&life] { return life > c_lifeMax / 100 * 80; },    // (80, 100]%
+            [] { return c_lifeMax / 100 * 25; },
+            [&life] { return life > c_lifeMax / 100 * 60; },    // (60, 80]%
+            [] { return c_lifeMax / 100 * 20; },
+            [&life] { return life > c_lifeMax / 100 * 40; },    // (40, 60]%
+            [] { return c_lifeMax / 100 * 15; },
+            [&life] { return life > c_lifeMax / 100 * 20; },    // (20, 40]%
+            [] { return c_lifeMax / 100 * 10; }
+        );                                                      // [0, 20]%
+        return life -= change;
+    }
+    struct RendBounds {
+        static constexpr auto min () -> Life { return 0; }
+        static constexpr auto max () -> Life { return c_lifeMax; }
+    };
+    static auto CastRend (Life& life, decltype(m_engine)& engine) -> decltype(life) {
+        AUTOMAGIC_TRACE_DETAIL("Rend");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Rend, life);
+        auto&& dis = BoundedUniformDistribution<Life, RendBounds>{};
+        auto&& divisor = recurse(
+            [] (auto&& gcd, auto a, auto b) {
+                if (b == decltype(b){})
+                    return a;
+                return gcd(std::forward<decltype(gcd)>(gcd), b, modulo(a, b));
             },
-            [] (auto& life, auto& engine) -> auto& {    // Rend
-                auto&& dis = make_uniform_distribution(0, c_lifeMax);
-                return life /= recurse(
-                    [] (auto&& gcd, auto&& a, auto&& b) {
-                        if (b == decltype(b){})
-                            return a;
-                        return gcd(std::forward<decltype(gcd)>(gcd), b, modulo(a, b));
-                    },
-                    life, 
-                    dis(engine)
-                );
-            }
+            life, 
+            static_cast<std::decay_t<decltype(life)>>(dis(engine))
         );
+        return divisor > 0 ? life /= divisor : life;
+    }
+    using Spell = decltype(&Game::CastHeal);
+    static constexpr Spell c_spells[] = {
+        &Game::CastHeal, 
+        &Game::CastHurt, 
+        &Game::CastMaim,
+        &Game::CastRend,
+    };
+
+    auto Turn () {
+        AUTOMAGIC_TRACE_DETAIL("Turn");
         auto&& spell = random_element(std::begin(c_spells), std::end(c_spells), m_engine);
         return (*spell)(m_life, m_engine) > 0;
     }
 };
 
+template <typename L>
+constexpr typename Game<L>::Life Game<L>::c_lifeMax;
+template <typename L>
+constexpr typename Game<L>::Spell Game<L>::c_spells[];
+
 } // namespace Version2_2
 
 //--------------------------------------------------------------------------------------------------
@@ -161,52 +240,81 @@ struct Game {
 //--------------------------------------------------------------------------------------------------
 namespace Version3_2 {
 
+template <typename L = unsigned int>
 struct Game {
     static constexpr auto c_playerCount = 4u;
-    using Life = unsigned int;
+    using Life = L;
     using LifeArray = std::array<Life, c_playerCount>;
 
-    static constexpr auto c_lifeMax{std::numeric_limits<Life>::max()};
+    static constexpr Life c_lifeMax{capped_max<Life, unsigned int>()};
     std::mt19937 m_engine{};
     LifeArray m_life{make_filled_array(m_life, c_lifeMax)};
 
-    auto Turn () {
-        using Spell = decltype(m_life[0])& (*)(decltype(m_life[0])&, decltype(m_engine)&);
-        static const auto c_spells = make_array<Spell>(
-            [] (auto& life, auto& engine) -> auto& {    //  Heal
-                auto&& dis = make_uniform_distribution(0, c_lifeMax - life);
-                return life += dis(engine);
-            }, 
-            [] (auto& life, auto& engine) -> auto& {    //  Hurt
-                auto&& dis = make_uniform_distribution(0, life);
-                return life -= dis(engine);
-            }/*, 
-            [] (auto& life, auto&) -> auto& {           //  Maim
-                auto&& change = choose(
-                    [&life] { return life > c_lifeMax / 100 * 80; },    // (80, 100]%
-                    [] { return c_lifeMax / 100 * 25; },
-                    [&life] { return life > c_lifeMax / 100 * 60; },    // (60, 80]%
-                    [] { return c_lifeMax / 100 * 20; },
-                    [&life] { return life > c_lifeMax / 100 * 40; },    // (40, 60]%
-                    [] { return c_lifeMax / 100 * 15; },
-                    [&life] { return life > c_lifeMax / 100 * 20; },    // (20, 40]%
-                    [] { return c_lifeMax / 100 * 10; }
-                );                                                      // [0, 20]%
-                return life -= change;
+    auto Reset (typename decltype(m_engine)::result_type seed) {
+        m_engine.seed(seed);
+        m_life = make_filled_array(m_life, c_lifeMax);
+    }
+    auto Reset (const decltype(m_engine)& engine) {
+        m_engine = engine;
+        m_life = make_filled_array(m_life, c_lifeMax);
+    }
+
+    static auto CastHeal (Life& life, decltype(m_engine)& engine) -> decltype(life) {
+        AUTOMAGIC_TRACE_DETAIL("Heal");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Heal, life);
+        auto&& dis = make_uniform_distribution(0, c_lifeMax - life);
+        return life = saturating_add(life, dis(engine));
+    }
+    static auto CastHurt (Life& life, decltype(m_engine)& engine) -> decltype(life) {
+        AUTOMAGIC_TRACE_DETAIL("Hurt");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Hurt, life);
+        auto&& dis = make_uniform_distribution(0, life);
+        return life -= dis(engine);
+    }
+    static auto CastMaim (Life& life, decltype(m_engine)&) -> decltype(life) {
+        AUTOMAGIC_TRACE_DETAIL("Maim");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Maim, life);
+        auto&& change = choose(
+            [&life] { return life > c_lifeMax / 100 * 80; },    // (80, 100]%
+            [] { return c_lifeMax / 100 * 25; },
+            [&life] { return life > c_lifeMax / 100 * 60; },    // (60, 80]%
+            [] { return c_lifeMax / 100 * 20; },
+            [&life] { return life > c_lifeMax / 100 * 40; },    // (40, 60]%
+            [] { return c_lifeMax / 100 * 15; },
+            [&life] { return life > c_lifeMax / 100 * 20; },    // (20, 40]%
+            [] { return c_lifeMax / 100 * 10; }
+        );                                                      // [0, 20]%
+        return life -= change;
+    }
+    struct RendBounds {
+        static constexpr auto min () -> Life { return 0; }
+        static constexpr auto max () -> Life { return c_lifeMax; }
+    };
+    static auto CastRend (Life& life, decltype(m_engine)& engine) -> decltype(life) {
+        AUTOMAGIC_TRACE_DETAIL("Rend");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Rend, life);
+        auto&& dis = BoundedUniformDistribution<Life, RendBounds>{};
+        auto&& divisor = recurse(
+            [] (auto&& gcd, auto a, auto b) {
+                if (b == decltype(b){})
+                    return a;
+                return gcd(std::forward<decltype(gcd)>(gcd), b, modulo(a, b));
             },
-            [] (auto& life, auto& engine) -> auto& {    // Rend
-                auto&& dis = make_uniform_distribution(0, c_lifeMax);
-                return life /= recurse(
-                    [] (auto&& gcd, auto a, auto b) {
-                        if (b == decltype(b){})
-                            return a;
-                        return gcd(std::forward<decltype(gcd)>(gcd), b, modulo(a, b));
-                    },
-                    life, 
-                    dis(engine)
-                );
-            }*/
+            life, 
+            static_cast<std::decay_t<decltype(life)>>(dis(engine))
         );
+        return divisor > 0 ? life /= divisor : life;
+    }
+    using Spell = decltype(&Game::CastHeal);
+    static constexpr Spell c_spells[] = {
+        &Game::CastHeal, 
+        &Game::CastHurt, 
+        //&Game::CastMaim,
+        //&Game::CastRend,
+    };
+
+    auto Turn () {
+        AUTOMAGIC_TRACE_DETAIL("Turn");
         return accumutate(
             std::begin(m_life),
             std::end(m_life),
@@ -222,4 +330,174 @@ struct Game {
     }
 };
 
+template <typename L>
+constexpr typename Game<L>::Life Game<L>::c_lifeMax;
+template <typename L>
+constexpr typename Game<L>::Spell Game<L>::c_spells[];
+
 } // namespace Version3_2
+
+//--------------------------------------------------------------------------------------------------
+//  Multiplayer, tunable
+//
+//  Version3_2's game with the engine and the way spells are dispatched as parameters, so that the
+//  fastest combination can be chosen per machine. The dispatch makes no difference to the outcome:
+//  with std::mt19937 every variant plays exactly as the rest of the family.
+//--------------------------------------------------------------------------------------------------
+namespace Version3_3 {
+
+struct MemberPointer { };      // Table of pointers to member functions, as Version3_0
+struct FunctionPointer { };    // Table of pointers to free functions, as Version3_2
+struct Switch { };             // switch on the spell's index, which inlines every spell
+
+template <typename L = unsigned int, typename E = std::mt19937, typename D = Switch>
+struct Game {
+    static constexpr auto c_playerCount = 4u;
+    static constexpr auto c_spellCount = std::size_t{2};
+    using Life = L;
+    using LifeArray = std::array<Life, c_playerCount>;
+    using Engine = E;
+    using Dispatch = D;
+
+    static constexpr Life c_lifeMax{capped_max<Life, unsigned int>()};
+    Engine m_engine{};
+    LifeArray m_life{make_filled_array(m_life, c_lifeMax)};
+
+    auto Reset (typename Engine::result_type seed) {
+        m_engine.seed(seed);
+        m_life = make_filled_array(m_life, c_lifeMax);
+    }
+    auto Reset (const Engine& engine) {
+        m_engine = engine;
+        m_life = make_filled_array(m_life, c_lifeMax);
+    }
+
+    static auto CastHeal (Life& life, Engine& engine) -> Life& {
+        AUTOMAGIC_TRACE_DETAIL("Heal");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Heal, life);
+        auto&& dis = make_uniform_distribution(0, c_lifeMax - life);
+        return life = saturating_add(life, dis(engine));
+    }
+    static auto CastHurt (Life& life, Engine& engine) -> Life& {
+        AUTOMAGIC_TRACE_DETAIL("Hurt");
+        AUTOMAGIC_SPELL_STATS_SCOPE(Hurt, life);
+        auto&& dis = make_uniform_distribution(0, life);
+        return life -= dis(engine);
+    }
+    auto CastHeal (Life& life) -> Life& { return CastHeal(life, m_engine); }
+    auto CastHurt (Life& life) -> Life& { return CastHurt(life, m_engine); }
+
+    auto Cast (std::size_t spell, Life& life, MemberPointer) -> Life& {
+        using Spell = Life& (Game::*)(Life&);
+        static constexpr Spell c_spells[] = { &Game::CastHeal, &Game::CastHurt, };
+        return (this->*c_spells[spell])(life);
+    }
+    auto Cast (std::size_t spell, Life& life, FunctionPointer) -> Life& {
+        using Spell = Life& (*)(Life&, Engine&);
+        static constexpr Spell c_spells[] = { &Game::CastHeal, &Game::CastHurt, };
+        return (*c_spells[spell])(life, m_engine);
+    }
+    auto Cast (std::size_t spell, Life& life, Switch) -> Life& {
+        switch (spell) {
+        case 0:
+            return CastHeal(life, m_engine);
+        default:
+            return CastHurt(life, m_engine);
+        }
+    }
+
+    auto Turn () {
+        AUTOMAGIC_TRACE_DETAIL("Turn");
+        auto anyAlive = false;
+        for (auto& life : m_life) {
+            if (life > 0) {
+                auto&& dis = make_uniform_distribution(std::size_t{0}, c_spellCount - 1);
+                anyAlive = Cast(dis(m_engine), life, Dispatch{}) > 0 || anyAlive;
+            }
+        }
+        return anyAlive;
+    }
+};
+
+template <typename L, typename E, typename D>
+constexpr typename Game<L, E, D>::Life Game<L, E, D>::c_lifeMax;
+
+} // namespace Version3_3
+
+//--------------------------------------------------------------------------------------------------
+//  Large lobbies
+//
+//  Every player draws from a SplitMix64 stream of its own, derived from m_engine when the game is
+//  reset, rather than all players drawing from m_engine in turn. A turn is then independent per
+//  player, so ParallelFor splits the players between threads and the loop over each chunk is
+//  left free of branches for the vectoriser. The outcome for a seed doesn't depend on the thread
+//  count. Only Heal and Hurt are cast, as in Version3_2; spell stats aren't
+//  recorded since the hot loop no longer calls the spells one at a time.
+//--------------------------------------------------------------------------------------------------
+namespace Version4_2 {
+
+// A lobby only ends when its last player dies, which takes far too long with 32 bit lives
+template <typename L = std::uint16_t, std::size_t N = 4096>
+struct Game {
+    static constexpr auto c_playerCount = N;
+    using Life = L;
+    using LifeArray = std::array<Life, c_playerCount>;
+    using StreamArray = std::array<SplitMix64, c_playerCount>;
+
+    // Draws are scaled from 32 bits, see Turn
+    static_assert(sizeof(Life) <= sizeof(std::uint32_t), "Life must fit in 32 bits");
+
+    static constexpr Life c_lifeMax{capped_max<Life, unsigned int>()};
+    std::mt19937 m_engine{};
+    LifeArray m_life;
+    StreamArray m_streams;
+
+    Game () { Restart(); }
+
+    auto Reset (typename decltype(m_engine)::result_type seed) {
+        m_engine.seed(seed);
+        Restart();
+    }
+    auto Reset (const decltype(m_engine)& engine) {
+        m_engine = engine;
+        Restart();
+    }
+
+    auto Restart () -> void {
+        m_life.fill(c_lifeMax);
+        const auto high = std::uint64_t{m_engine()};
+        const auto low = std::uint64_t{m_engine()};
+        const auto base = high << 32 | low;
+        for (std::size_t i = 0; i != c_playerCount; ++i)
+            m_streams[i].m_state = SplitMix64::Mix(base + i);
+    }
+
+    // The low bit of a draw chooses Hurt or Heal and the high 32 bits scale to the change in
+    // [0, bound]. Which spell is cast is a coin toss, so the choices are made with masks rather
+    // than branches which would be mispredicted half the time.
+    auto Turn () {
+        AUTOMAGIC_TRACE_DETAIL("Turn");
+        std::atomic<bool> anyAlive{false};
+        ParallelFor::Get().Run(c_playerCount, [this, &anyAlive] (auto first, auto last) {
+            auto alive = false;
+            for (auto i = first; i != last; ++i) {
+                const auto bits = m_streams[i]();
+                const std::uint64_t life = m_life[i];
+                const auto heal = 0 - (bits & 1);
+                const auto bound = life ^ ((life ^ (c_lifeMax - life)) & heal);
+                const auto change = ((bits >> 32) * (bound + 1)) >> 32;
+                const auto next = life + ((change ^ ~heal) - ~heal);
+                m_life[i] = static_cast<Life>(next & (0 - std::uint64_t{life > 0}));
+                alive |= m_life[i] > 0;
+            }
+            if (alive)
+                anyAlive.store(true, std::memory_order_relaxed);
+        });
+        return anyAlive.load(std::memory_order_relaxed);
+    }
+};
+
+template <typename L, std::size_t N>
+constexpr typename Game<L, N>::Life Game<L, N>::c_lifeMax;
+
+} // namespace Version4_2
@@ -0,0 +1,147 @@
+//--------------------------------------------------------------------------------------------------
+//  Copyright 2016 Andy Bond
+// 
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//  
+//  http://www.apache.org/licenses/LICENSE-2.0
+//  
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//--------------------------------------------------------------------------------------------------
+#pragma once
+
+#include "aux_chrono.h"
+
+//--------------------------------------------------------------------------------------------------
+//  Per-spell attribution counters: how often each spell is cast, how many cycles it takes and how
+//  much life it moves. Counters live in a thread_local block, so casting a spell only touches
+//  memory owned by its own thread; blocks are folded into a shared total when their thread exits
+//  or when the owning thread collects them.
+//
+//  Everything compiles out unless AUTOMAGIC_SPELL_STATS is defined to a non-zero value.
+//--------------------------------------------------------------------------------------------------
+#ifndef AUTOMAGIC_SPELL_STATS
+#define AUTOMAGIC_SPELL_STATS 0
+#endif
+
+#if AUTOMAGIC_SPELL_STATS
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
+
+//--------------------------------------------------------------------------------------------------
+enum class SpellId : std::size_t {
+    Heal,
+    Hurt,
+    Maim,
+    Rend,
+    Count,
+};
+
+static constexpr const char* c_spellNames[] = { "Heal", "Hurt", "Maim", "Rend", };
+
+//--------------------------------------------------------------------------------------------------
+struct SpellCounters {
+    std::uint64_t m_calls{};
+    std::uint64_t m_cycles{};
+    double m_lifeDelta{};
+
+    SpellCounters& operator+= (const SpellCounters& rhs) {
+        m_calls += rhs.m_calls;
+        m_cycles += rhs.m_cycles;
+        m_lifeDelta += rhs.m_lifeDelta;
+        return *this;
+    }
+};
+
+using SpellCounterArray = std::array<SpellCounters, static_cast<std::size_t>(SpellId::Count)>;
+
+//--------------------------------------------------------------------------------------------------
+struct SpellStatsLog {
+    std::mutex m_mutex;
+    SpellCounterArray m_totals{};
+
+    static SpellStatsLog& Get () {
+        static SpellStatsLog s_log;
+        return s_log;
+    }
+
+    void Merge (SpellCounterArray& counters) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (std::size_t i = 0; i < counters.size(); ++i)
+            m_totals[i] += counters[i];
+        counters = SpellCounterArray{};
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+struct SpellStatsBuffer {
+    SpellStatsLog& m_log{SpellStatsLog::Get()};
+    SpellCounterArray m_counters{};
+
+    static SpellStatsBuffer& Get () {
+        static thread_local SpellStatsBuffer t_buffer;
+        return t_buffer;
+    }
+
+    ~SpellStatsBuffer () {
+        m_log.Merge(m_counters);
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+//  collect_spell_stats returns everything counted so far by exited threads and the calling thread,
+//  and resets those counters so the next collection starts from zero.
+//--------------------------------------------------------------------------------------------------
+inline SpellCounterArray collect_spell_stats () {
+    auto& log = SpellStatsLog::Get();
+    log.Merge(SpellStatsBuffer::Get().m_counters);
+
+    std::lock_guard<std::mutex> lock(log.m_mutex);
+    auto totals = log.m_totals;
+    log.m_totals = SpellCounterArray{};
+    return totals;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  SpellStatsScope attributes its own lifetime and the change it observes in 'life' to a spell.
+//--------------------------------------------------------------------------------------------------
+template <typename Life>
+struct SpellStatsScope {
+    SpellCounters& m_counters;
+    const Life& m_life;
+    const Life m_before;
+    const std::uint64_t m_start;
+
+    SpellStatsScope (SpellId id, const Life& life) :
+        m_counters(SpellStatsBuffer::Get().m_counters[static_cast<std::size_t>(id)]),
+        m_life(life),
+        m_before(life),
+        m_start(read_cycle_counter())
+    { }
+
+    SpellStatsScope (const SpellStatsScope&) = delete;
+    SpellStatsScope& operator= (const SpellStatsScope&) = delete;
+
+    ~SpellStatsScope () {
+        m_counters.m_cycles += read_cycle_counter() - m_start;
+        m_counters.m_lifeDelta += static_cast<double>(m_life) - static_cast<double>(m_before);
+        ++m_counters.m_calls;
+    }
+};
+
+#define AUTOMAGIC_SPELL_STATS_SCOPE(spell, life) \
+    const SpellStatsScope<std::decay_t<decltype(life)>> spellStats##spell(SpellId::spell, (life))
+
+#else
+
+#define AUTOMAGIC_SPELL_STATS_SCOPE(spell, life) (void)0
+
+#endif